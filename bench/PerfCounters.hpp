@@ -0,0 +1,122 @@
+//
+// PerfCounters.hpp
+// GOLRenderer bench
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef PERFCOUNTERS_HPP_
+#define PERFCOUNTERS_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+// Hardware counters of the calling thread through perf_event_open, user
+// space only. Every counter is opened on its own so a missing one (LLC
+// misses in most VMs) does not take the others down, and values are scaled
+// up when the kernel had to multiplex them. Elsewhere than Linux, or with
+// perf_event_paranoid too strict, nothing opens and available() is false.
+class PerfCounters
+{
+public:
+  enum Counter { Cycles, Instructions, LLCMisses, BranchMisses, Count };
+  static constexpr char const* Names[Count] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+
+  struct Values
+  {
+    std::array<u64, Count> counts{};
+    std::array<bool, Count> valid{};
+  };
+
+  PerfCounters()
+  {
+    m_fds.fill(-1);
+#if defined(__linux__)
+    u64 const configs[Count] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (usz i = 0; i < Count; ++i)
+    {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      m_fds[i] = i32(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+    if (!available())
+      std::println(stderr, "PerfCounters: perf_event_open failed, check /proc/sys/kernel/perf_event_paranoid");
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  ~PerfCounters()
+  {
+#if defined(__linux__)
+    for (i32 fd : m_fds)
+      if (fd >= 0)
+        close(fd);
+#endif
+  }
+
+  bool available() const
+  {
+    for (i32 fd : m_fds)
+      if (fd >= 0)
+        return true;
+    return false;
+  }
+
+  void start()
+  {
+#if defined(__linux__)
+    for (i32 fd : m_fds)
+      if (fd >= 0)
+      {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif
+  }
+
+  Values stop()
+  {
+    Values values;
+#if defined(__linux__)
+    for (usz i = 0; i < Count; ++i)
+    {
+      if (m_fds[i] < 0)
+        continue;
+      ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      // value, time enabled, time running
+      u64 data[3];
+      if (read(m_fds[i], data, sizeof(data)) != sizeof(data) || !data[2])
+        continue;
+      values.counts[i] = data[2] < data[1] ? u64(f64(data[0]) * data[1] / data[2]) : data[0];
+      values.valid[i] = true;
+    }
+#endif
+    return values;
+  }
+
+private:
+  std::array<i32, Count> m_fds;
+};
+
+#endif // PERFCOUNTERS_HPP_
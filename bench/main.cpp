@@ -0,0 +1,439 @@
+//
+// main.cpp
+// GOLRenderer bench
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#include <MyTypes.hpp>
+#include <print>
+#include <chrono>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+#include "Life.hpp"
+#include "Stepper.hpp"
+#include "Macrocell.hpp"
+#include "PerfCounters.hpp"
+
+// Runs every stepping kernel of Life.hpp and Stepper.hpp over a matrix of
+// grid sizes and starting patterns, one JSON object per run on stdout (or
+// --out file):
+//   bench [--quick] [--min-time seconds] [--pattern file.mc] [--counters] [--threads count]
+//         [--band-rows rows] [--out file.json]
+//   bench --scaling [--max-size cells] [--band-rows rows] [--quick] [--min-time seconds] [--out file.json]
+// Every run starts from a fresh copy of its pattern, so kernels see the same
+// generations. bytes_per_generation is the traffic the kernel has to move
+// at least (every buffer it reads or writes once per pass), not a measurement.
+// --counters adds hardware counters of the timed loop where perf allows it,
+// with IPC and the bytes per cell that missed the last level cache. They
+// only see the calling thread, --threads 1 counts all of a stepper kernel.
+// --scaling steps a soup with both Stepper kernels over every thread count
+// and square grids from 512 cells up to --max-size, next to a multithreaded
+// copy of a buffer far larger than any cache: the bandwidth the machine
+// gives a plain stream, which the kernels' traffic is compared against.
+
+struct Grid
+{
+  i32 width, height;
+  std::vector<i8> current, next, ages;
+  std::vector<u8> dirty_rows, packed, render;
+
+  Grid(i32 width, i32 height)
+  : width{width}, height{height}
+  {
+    usz const cells = usz(width) * height;
+    current.resize(cells);
+    next.resize(cells);
+    ages.resize(cells, 20);
+    dirty_rows.resize(height);
+    packed.resize(cells / 2);
+    render.resize(cells);
+  }
+
+  usz cells() const { return current.size(); }
+
+  void set(i32 x, i32 y)
+  {
+    usz const i = usz((x % width + width) % width) + usz((y % height + height) % height) * width;
+    current[i] = 1;
+    ages[i] = 21;
+  }
+};
+
+struct Kernel
+{
+  char const* name;
+  // bytes read plus written per cell and generation
+  f64 bytes_per_cell;
+  std::function<void(Grid&)> step;
+  usz threads = 1;
+};
+
+struct Pattern
+{
+  std::string name;
+  f64 density;
+  std::function<void(Grid&)> fill;
+};
+
+// life RLE without the header line, placed with its top left corner at (x, y)
+void place_rle(Grid& grid, std::string_view rle, i32 x, i32 y)
+{
+  i32 column = x, count = 0;
+  for (char c : rle)
+  {
+    if (std::isdigit(c))
+    {
+      count = count * 10 + (c - '0');
+      continue;
+    }
+    i32 const run = count ? count : 1;
+    count = 0;
+    if (c == 'o')
+      for (i32 i = 0; i < run; ++i)
+        grid.set(column++, y);
+    else if (c == 'b')
+      column += run;
+    else if (c == '$')
+    {
+      y += run;
+      column = x;
+    }
+    else if (c == '!')
+      return;
+  }
+}
+
+constexpr std::string_view RPentomino = "b2o$2o$bo!";
+constexpr std::string_view GosperGun =
+  "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4bobo$"
+  "10bo5bo7bo$11bo3bo$12b2o!";
+
+std::vector<Pattern> patterns(char const* macrocell_path)
+{
+  std::vector<Pattern> result;
+  result.push_back({"empty", 0, [](Grid&) {}});
+  for (f64 density : {1. / 12, 0.25, 0.5})
+    result.push_back({"soup", density, [density](Grid& grid) {
+      std::mt19937 generator(1);
+      std::bernoulli_distribution alive(density);
+      for (i32 y = 0; y < grid.height; ++y)
+        for (i32 x = 0; x < grid.width; ++x)
+          if (alive(generator))
+            grid.set(x, y);
+    }});
+  result.push_back({"rpentomino", 0, [](Grid& grid) {
+    place_rle(grid, RPentomino, grid.width / 2, grid.height / 2);
+  }});
+  // no breeder ships with the repo, a lattice of glider guns is the
+  // built-in structured pattern that keeps growing. Pass a breeder as .mc.
+  result.push_back({"guns", 0, [](Grid& grid) {
+    for (i32 y = 0; y + 9 <= grid.height; y += 64)
+      for (i32 x = 0; x + 36 <= grid.width; x += 128)
+        place_rle(grid, GosperGun, x, y);
+  }});
+  if (macrocell_path)
+  {
+    auto universe = std::make_shared<Macrocell>();
+    if (universe->load(macrocell_path))
+      result.push_back({macrocell_path, 0, [universe](Grid& grid) {
+        universe->rasterize(grid.current.data(), grid.width, grid.height);
+        for (usz i = 0; i < grid.cells(); ++i)
+          grid.ages[i] = grid.current[i] == 1 ? 21 : 20;
+      }});
+  }
+  return result;
+}
+
+// the Stepper kernels run on threads threads in bands of band_rows
+std::vector<Kernel> kernels(usz threads, i32 band_rows)
+{
+  auto stepper = [&](Stepper::Kernel kernel) {
+    auto pool = std::make_shared<Stepper>(Stepper::Config{.kernel = kernel, .threads = threads,
+                                                          .band_rows = band_rows});
+    return [pool](Grid& grid) {
+      pool->step(grid.current.data(), grid.next.data(), grid.width, grid.height,
+                 {.ages = grid.ages.data(), .dirty_rows = grid.dirty_rows.data()});
+    };
+  };
+  return {
+    // counts: read current, write next. Rule: read current and next, write
+    // next, read and write ages
+    {"step", 7, [](Grid& grid) {
+      life::step(grid.current.data(), grid.next.data(), grid.width, grid.height,
+                 {.ages = grid.ages.data(), .dirty_rows = grid.dirty_rows.data()});
+    }},
+    {"step-packed", 7.5, [](Grid& grid) {
+      life::step(grid.current.data(), grid.next.data(), grid.width, grid.height,
+                 {.ages = grid.ages.data(), .dirty_rows = grid.dirty_rows.data(),
+                  .packed = grid.packed.data()});
+    }},
+    {"step-render", 8, [](Grid& grid) {
+      life::step(grid.current.data(), grid.next.data(), grid.width, grid.height,
+                 {.ages = grid.ages.data(), .dirty_rows = grid.dirty_rows.data(),
+                  .render = grid.render.data()});
+    }},
+    {"step-cells", 5, [](Grid& grid) {
+      life::stepCells(grid.current.data(), grid.next.data(), grid.width, grid.height);
+    }},
+    // step split over bands, fused keeps the counts of a band in cache
+    {"stepper-passes", 7, stepper(Stepper::Kernel::Passes), threads},
+    {"stepper-fused", 4, stepper(Stepper::Kernel::Fused), threads},
+  };
+}
+
+// bytes per second of memcpy over threads slices of a 256 MB buffer into
+// another, reads and writes both counted
+f64 stream_copy(usz threads, f64 min_time)
+{
+  usz const bytes = usz(256) << 20;
+  std::vector<u8> source(bytes, 1), destination(bytes);
+  auto copy = [&] {
+    usz const slice = bytes / threads;
+    std::vector<std::thread> workers;
+    for (usz t = 1; t < threads; ++t)
+      workers.emplace_back([&, t] { memcpy(destination.data() + t * slice, source.data() + t * slice, slice); });
+    memcpy(destination.data(), source.data(), slice);
+    for (std::thread& worker : workers)
+      worker.join();
+    return slice * threads;
+  };
+  // first touch of the destination
+  copy();
+  using clock = std::chrono::steady_clock;
+  auto const start = clock::now();
+  f64 seconds = 0, copied = 0;
+  do
+  {
+    copied += copy();
+    seconds = std::chrono::duration<f64>(clock::now() - start).count();
+  } while (seconds < min_time);
+  return 2 * copied / seconds;
+}
+
+// thread counts from 1 to every hardware thread, powers of two in between
+std::vector<usz> thread_counts()
+{
+  usz const hardware = std::max<usz>(std::thread::hardware_concurrency(), 1);
+  std::vector<usz> counts;
+  for (usz count = 1; count < hardware; count *= 2)
+    counts.push_back(count);
+  counts.push_back(hardware);
+  return counts;
+}
+
+int scaling(FILE* out, bool quick, f64 min_time, i32 max_size, i32 band_rows)
+{
+  // least traffic per cell and generation: passes writes the counts to next
+  // and reads them back, fused keeps a band of counts in cache
+  struct Variant { Stepper::Kernel kernel; f64 bytes_per_cell; };
+  Variant const variants[] = {{Stepper::Kernel::Passes, 7}, {Stepper::Kernel::Fused, 4}};
+  std::vector<usz> const threads = thread_counts();
+  std::vector<f64> stream;
+  for (usz count : threads)
+    stream.push_back(stream_copy(count, quick ? 0.1 : min_time));
+
+  std::println(out, "[");
+  bool first = true;
+  for (usz i = 0; i < threads.size(); ++i)
+  {
+    std::print(out, "{}  {{\"mode\": \"stream\", \"threads\": {}, \"bytes_per_sec\": {:.6e}}}",
+               first ? "" : ",\n", threads[i], stream[i]);
+    first = false;
+  }
+  for (i32 size = 512; size <= max_size; size *= 2)
+    for (Variant const& variant : variants)
+    {
+      Grid soup(size, size);
+      std::mt19937 generator(1);
+      std::bernoulli_distribution alive(1. / 12);
+      for (usz i = 0; i < soup.cells(); ++i)
+        if (alive(generator))
+        {
+          soup.current[i] = 1;
+          soup.ages[i] = 21;
+        }
+      f64 single = 0;
+      for (usz t = 0; t < threads.size(); ++t)
+      {
+        Grid grid = soup;
+        Stepper stepper({.kernel = variant.kernel, .threads = threads[t], .band_rows = band_rows});
+        auto step = [&] {
+          stepper.step(grid.current.data(), grid.next.data(), grid.width, grid.height,
+                       {.ages = grid.ages.data(), .dirty_rows = grid.dirty_rows.data()});
+          std::swap(grid.current, grid.next);
+        };
+        // first touch and the pool awake outside the timed loop
+        step();
+        using clock = std::chrono::steady_clock;
+        u64 generations = 0;
+        auto const start = clock::now();
+        f64 seconds = 0;
+        do
+        {
+          step();
+          generations++;
+          seconds = std::chrono::duration<f64>(clock::now() - start).count();
+        } while (seconds < min_time || generations < 3);
+
+        f64 const gens_per_sec = generations / seconds;
+        if (t == 0)
+          single = gens_per_sec;
+        f64 const bytes_per_sec = variant.bytes_per_cell * grid.cells() * gens_per_sec;
+        std::print(out, "{}  {{\"mode\": \"scaling\", \"kernel\": \"{}\", \"threads\": {}, \"band_rows\": {}, "
+                        "\"width\": {}, \"height\": {}, \"generations\": {}, \"seconds\": {:.6f}, "
+                        "\"gens_per_sec\": {:.3f}, \"cells_per_sec\": {:.6e}, \"speedup\": {:.3f}, "
+                        "\"efficiency\": {:.3f}, \"bytes_per_sec\": {:.6e}, \"of_stream_copy\": {:.3f}}}",
+                   first ? "" : ",\n", Stepper::name(variant.kernel), threads[t], band_rows,
+                   grid.width, grid.height, generations, seconds,
+                   gens_per_sec, gens_per_sec * grid.cells(), gens_per_sec / single,
+                   gens_per_sec / single / threads[t], bytes_per_sec, bytes_per_sec / stream[t]);
+        fflush(out);
+        first = false;
+      }
+    }
+  std::println(out, "\n]");
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  bool quick = false;
+  f64 min_time = 0.5;
+  char const* macrocell_path = nullptr;
+  char const* out_path = nullptr;
+  bool counters = false;
+  bool scaling_report = false;
+  // 8192^2 cells need about 200 MB over the three grids, far beyond any cache
+  i32 max_size = 8192;
+  i32 band_rows = 32;
+  usz threads = std::max<usz>(std::thread::hardware_concurrency(), 1);
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string_view arg = argv[i];
+    if (arg == "--quick")
+      quick = true;
+    else if (arg == "--min-time" && i + 1 < argc)
+      min_time = std::strtod(argv[++i], nullptr);
+    else if (arg == "--pattern" && i + 1 < argc)
+      macrocell_path = argv[++i];
+    else if (arg == "--counters")
+      counters = true;
+    else if (arg == "--out" && i + 1 < argc)
+      out_path = argv[++i];
+    else if (arg == "--scaling")
+      scaling_report = true;
+    else if (arg == "--max-size" && i + 1 < argc)
+      max_size = std::atoi(argv[++i]);
+    else if (arg == "--threads" && i + 1 < argc)
+      threads = std::max(std::atoi(argv[++i]), 1);
+    else if (arg == "--band-rows" && i + 1 < argc)
+      band_rows = std::max(std::atoi(argv[++i]), 1);
+    else
+    {
+      std::println(stderr, "usage: {} [--quick] [--min-time seconds] [--pattern file.mc] [--counters] [--threads count]\n"
+                           "       [--band-rows rows] [--out file.json]\n"
+                           "       {} --scaling [--max-size cells] [--band-rows rows] [--quick] [--min-time seconds] [--out file.json]",
+                   argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  FILE* out = stdout;
+  if (out_path && !(out = fopen(out_path, "w")))
+  {
+    std::println(stderr, "bench: could not open {}", out_path);
+    return 1;
+  }
+
+  if (scaling_report)
+  {
+    int const result = scaling(out, quick, min_time, quick ? 1024 : max_size, band_rows);
+    if (out != stdout)
+      fclose(out);
+    return result;
+  }
+
+  struct Size { i32 width, height; };
+  std::vector<Size> sizes = {{256, 256}, {1024, 1024}, {3840, 2160}};
+  if (quick)
+    sizes = {{256, 256}};
+
+  std::unique_ptr<PerfCounters> perf;
+  if (counters)
+    perf = std::make_unique<PerfCounters>();
+
+  std::println(out, "[");
+  bool first = true;
+  for (Size const size : sizes)
+    for (Pattern const& pattern : patterns(macrocell_path))
+      for (Kernel const& kernel : kernels(threads, band_rows))
+      {
+        Grid grid(size.width, size.height);
+        pattern.fill(grid);
+        // first touch of every buffer outside the timed loop
+        kernel.step(grid);
+        std::swap(grid.current, grid.next);
+
+        using clock = std::chrono::steady_clock;
+        u64 generations = 0;
+        if (perf)
+          perf->start();
+        auto const start = clock::now();
+        f64 seconds = 0;
+        do
+        {
+          kernel.step(grid);
+          std::swap(grid.current, grid.next);
+          generations++;
+          seconds = std::chrono::duration<f64>(clock::now() - start).count();
+        } while (seconds < min_time || generations < 3);
+        PerfCounters::Values const values = perf ? perf->stop() : PerfCounters::Values{};
+
+        u64 population = 0;
+        for (i8 cell : grid.current)
+          population += cell;
+        f64 const cells = f64(grid.cells());
+        std::print(out, "{}  {{\"kernel\": \"{}\", \"threads\": {}, \"width\": {}, \"height\": {}, \"pattern\": \"{}\", "
+                        "\"density\": {:.4f}, \"generations\": {}, \"seconds\": {:.6f}, "
+                        "\"gens_per_sec\": {:.3f}, \"cells_per_sec\": {:.6e}, "
+                        "\"bytes_per_generation\": {:.0f}, \"bytes_per_sec\": {:.6e}, \"population\": {}",
+                   first ? "" : ",\n", kernel.name, kernel.threads, grid.width, grid.height, pattern.name,
+                   pattern.density, generations, seconds,
+                   generations / seconds, generations * cells / seconds,
+                   kernel.bytes_per_cell * cells, kernel.bytes_per_cell * cells * generations / seconds,
+                   population);
+        f64 const stepped = cells * generations;
+        for (usz i = 0; i < PerfCounters::Count; ++i)
+          if (values.valid[i])
+            std::print(out, ", \"{}\": {}, \"{}_per_cell\": {:.4f}", PerfCounters::Names[i], values.counts[i],
+                       PerfCounters::Names[i], values.counts[i] / stepped);
+        if (values.valid[PerfCounters::Cycles] && values.valid[PerfCounters::Instructions])
+          std::print(out, ", \"ipc\": {:.3f}",
+                     f64(values.counts[PerfCounters::Instructions]) / values.counts[PerfCounters::Cycles]);
+        // every miss is one 64 byte line from memory, the closest to bandwidth a user counter gets
+        if (values.valid[PerfCounters::LLCMisses])
+          std::print(out, ", \"llc_bytes_per_cell\": {:.4f}, \"llc_bytes_per_sec\": {:.6e}",
+                     values.counts[PerfCounters::LLCMisses] * 64 / stepped,
+                     values.counts[PerfCounters::LLCMisses] * 64 / seconds);
+        std::print(out, "}}");
+        fflush(out);
+        first = false;
+      }
+  std::println(out, "\n]");
+  if (out != stdout)
+    fclose(out);
+  return 0;
+}
@@ -12,11 +12,13 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 template <typename T, size_t N>
 class Array
 {
   T* raw_data = nullptr;
+  bool owned = true;
   // T raw_data[N];
 public:
   using type_t = T;
@@ -31,7 +33,18 @@ public:
   Array& operator=(const Array&) = delete;
 
   ~Array() {
-    delete[] raw_data;
+    if (owned)
+      delete[] raw_data;
+  }
+
+  // moves the contents to memory owned by someone else (e.g. shared memory),
+  // which has to outlive every use of the array
+  void rebind(T* storage) {
+    memcpy(storage, raw_data, sizeof(T) * N);
+    if (owned)
+      delete[] raw_data;
+    raw_data = storage;
+    owned = false;
   }
 
   static constexpr size_t ByteCapacity() { return sizeof(T) * N; }
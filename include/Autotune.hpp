@@ -0,0 +1,283 @@
+//
+// Autotune.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef AUTOTUNE_HPP_
+#define AUTOTUNE_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(_WIN32)
+# include <unistd.h>
+#endif
+
+#include "Stepper.hpp"
+
+// Finds the Stepper configuration that steps a soup fastest on this host
+// and keeps it in a profile file, one line per host and grid size:
+//   gol-tune 1
+//   <host> <width> <height> <kernel> <threads> <band rows> <gens per sec>
+// The profile can be shared between machines, every host only reads and
+// replaces its own lines.
+namespace autotune
+{
+
+struct Result
+{
+  Stepper::Config config;
+  f64 gens_per_sec = 0;
+};
+
+inline std::string hostName()
+{
+#if defined(_WIN32)
+  char const* name = std::getenv("COMPUTERNAME");
+  return name ? name : "unknown";
+#else
+  char name[256] = {};
+  if (gethostname(name, sizeof(name) - 1) != 0 || !name[0])
+    return "unknown";
+  return name;
+#endif
+}
+
+// both kernels with powers of two threads up to every hardware thread and
+// band heights from 8 to 256 rows. One thread of passes is life::step, the
+// band height does not matter there. The list starts with life::step, then
+// goes from the likeliest configurations (all threads or one, bands of 32
+// rows) to the least likely, so a short budget can take the front of it.
+inline std::vector<Stepper::Config> candidates(usz max_threads)
+{
+  std::vector<usz> threads;
+  for (usz count = 1; count < max_threads; count *= 2)
+    threads.push_back(count);
+  threads.push_back(std::max<usz>(max_threads, 1));
+  std::vector<Stepper::Config> result;
+  for (Stepper::Kernel kernel : {Stepper::Kernel::Passes, Stepper::Kernel::Fused})
+    for (usz count : threads)
+      for (i32 band_rows : {8, 16, 32, 64, 128, 256})
+      {
+        if (kernel == Stepper::Kernel::Passes && count == 1 && band_rows != 8)
+          continue;
+        result.push_back({kernel, count, band_rows});
+      }
+  usz const most = std::max<usz>(max_threads, 1);
+  auto distance = [most](Stepper::Config const& config) {
+    if (config.kernel == Stepper::Kernel::Passes && config.threads == 1)
+      return -1;
+    i32 const band = std::abs(std::countr_zero(u32(config.band_rows)) - 5);
+    i32 threads = 0;
+    for (usz count = config.threads; count != 1 && count < most; count *= 2)
+      threads++;
+    return band + threads;
+  };
+  std::stable_sort(result.begin(), result.end(), [&](Stepper::Config const& a, Stepper::Config const& b) {
+    return distance(a) < distance(b);
+  });
+  return result;
+}
+
+// a soup with the density of the app, stepped the way the app steps it
+class Soup
+{
+public:
+  Soup(i32 width, i32 height, f64 density, bool packed)
+  : m_width{width}, m_height{height}
+  , m_cells(usz(width) * height), m_ages(usz(width) * height, 20)
+  , m_next(usz(width) * height), m_dirty_rows(height)
+  {
+    std::mt19937 generator(1);
+    std::bernoulli_distribution alive(density);
+    for (usz i = 0; i < m_cells.size(); ++i)
+      if (alive(generator))
+      {
+        m_cells[i] = 1;
+        m_ages[i] = 21;
+      }
+    if (packed)
+      m_packed.resize(m_cells.size() / 2);
+  }
+
+  // generations per second of config, stepping for about seconds but at
+  // least min_generations from the first generation of the soup
+  f64 measure(Stepper::Config const& config, f64 seconds, u64 min_generations) const
+  {
+    std::vector<i8> current = m_cells, next = m_next, ages = m_ages;
+    std::vector<u8> dirty_rows = m_dirty_rows, packed = m_packed;
+    Stepper stepper(config);
+    life::Output const output{.ages = ages.data(), .dirty_rows = dirty_rows.data(),
+                              .packed = packed.empty() ? nullptr : packed.data()};
+    // the first generation touches every page and wakes the pool
+    stepper.step(current.data(), next.data(), m_width, m_height, output);
+    std::swap(current, next);
+
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    u64 generations = 0;
+    f64 elapsed = 0;
+    do
+    {
+      stepper.step(current.data(), next.data(), m_width, m_height, output);
+      std::swap(current, next);
+      generations++;
+      elapsed = std::chrono::duration<f64>(clock::now() - start).count();
+    } while (elapsed < seconds || generations < min_generations);
+    return generations / elapsed;
+  }
+
+private:
+  i32 m_width, m_height;
+  std::vector<i8> m_cells, m_ages, m_next;
+  std::vector<u8> m_dirty_rows, m_packed;
+};
+
+// times candidates on a soup for about budget_seconds. life::step is timed
+// first, which says how many candidates half of what is left affords when
+// every one gets at least MinGenerations generations and MinSeconds, plus
+// its untimed first generation. The best few of those are timed again with
+// the rest if it affords them, so a lucky first measurement does not win.
+// A budget too short for that still times life::step and one more candidate.
+inline Result tune(i32 width, i32 height, f64 density, bool packed, f64 budget_seconds)
+{
+  constexpr usz Finalists = 3;
+  constexpr u64 MinGenerations = 5;
+  constexpr f64 MinSeconds = 0.02;
+  using clock = std::chrono::steady_clock;
+  auto const start = clock::now();
+  auto left = [&] {
+    return budget_seconds - std::chrono::duration<f64>(clock::now() - start).count();
+  };
+  Soup const soup(width, height, density, packed);
+  std::vector<Stepper::Config> configs = candidates(std::thread::hardware_concurrency());
+  std::vector<Result> results;
+  results.push_back({configs.front(), soup.measure(configs.front(), MinSeconds, MinGenerations)});
+  // threads only make a generation cheaper
+  f64 const generation = 1 / results.front().gens_per_sec;
+  f64 const cost = std::max(MinSeconds, MinGenerations * generation) + generation;
+  f64 const round = left() / 2;
+  configs.resize(std::min(configs.size(), std::max(usz(round / cost), usz(1)) + 1));
+  f64 const seconds = std::max(MinSeconds, round / (configs.size() - 1) - generation);
+  for (usz i = 1; i < configs.size(); ++i)
+    results.push_back({configs[i], soup.measure(configs[i], seconds, MinGenerations)});
+  std::sort(results.begin(), results.end(), [](Result const& a, Result const& b) {
+    return a.gens_per_sec > b.gens_per_sec;
+  });
+  results.resize(std::min(results.size(), Finalists));
+  if (left() >= results.size() * cost)
+  {
+    f64 const final_seconds = std::max(MinSeconds, left() / results.size() - generation);
+    for (Result& result : results)
+      result.gens_per_sec = soup.measure(result.config, final_seconds, MinGenerations);
+  }
+  return *std::max_element(results.begin(), results.end(), [](Result const& a, Result const& b) {
+    return a.gens_per_sec < b.gens_per_sec;
+  });
+}
+
+namespace detail
+{
+
+struct Line
+{
+  std::string host;
+  i32 width = 0, height = 0;
+  std::string kernel;
+  Result result;
+};
+
+inline bool parse(std::string const& text, Line& line)
+{
+  std::istringstream in(text);
+  if (!(in >> line.host >> line.width >> line.height >> line.kernel >> line.result.config.threads
+           >> line.result.config.band_rows >> line.result.gens_per_sec))
+    return false;
+  if (line.kernel == Stepper::name(Stepper::Kernel::Fused))
+    line.result.config.kernel = Stepper::Kernel::Fused;
+  else if (line.kernel == Stepper::name(Stepper::Kernel::Passes))
+    line.result.config.kernel = Stepper::Kernel::Passes;
+  else
+    return false;
+  return true;
+}
+
+} // namespace detail
+
+// the configuration tuned on this host for the grid size, false when there is none
+inline bool load(char const* path, i32 width, i32 height, Result& result)
+{
+  std::ifstream file(path);
+  std::string text;
+  if (!file || !std::getline(file, text) || text != "gol-tune 1")
+    return false;
+  std::string const host = hostName();
+  while (std::getline(file, text))
+  {
+    detail::Line line;
+    if (!detail::parse(text, line))
+    {
+      std::println(stderr, "autotune: {}: bad line \"{}\"", path, text);
+      return false;
+    }
+    if (line.host == host && line.width == width && line.height == height)
+    {
+      result = line.result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// replaces the line of this host and grid size, keeps the others
+inline bool save(char const* path, i32 width, i32 height, Result const& result)
+{
+  std::string const host = hostName();
+  std::vector<std::string> kept;
+  {
+    std::ifstream file(path);
+    std::string text;
+    if (file && std::getline(file, text) && text == "gol-tune 1")
+      while (std::getline(file, text))
+      {
+        detail::Line line;
+        if (detail::parse(text, line) && !(line.host == host && line.width == width && line.height == height))
+          kept.push_back(text);
+      }
+  }
+  FILE* file = fopen(path, "w");
+  if (!file)
+  {
+    std::println(stderr, "autotune: could not open {}", path);
+    return false;
+  }
+  std::println(file, "gol-tune 1");
+  for (std::string const& text : kept)
+    std::println(file, "{}", text);
+  std::println(file, "{} {} {} {} {} {} {:.2f}", host, width, height, Stepper::name(result.config.kernel),
+               result.config.threads, result.config.band_rows, result.gens_per_sec);
+  if (fclose(file) != 0)
+  {
+    std::println(stderr, "autotune: could not write {}", path);
+    return false;
+  }
+  return true;
+}
+
+} // namespace autotune
+
+#endif // AUTOTUNE_HPP_
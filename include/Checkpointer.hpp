@@ -0,0 +1,229 @@
+//
+// Checkpointer.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef CHECKPOINTER_HPP_
+#define CHECKPOINTER_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+
+#include "Trace.hpp"
+
+// Periodic snapshots of the cells and their ages for long runs.
+// Every `interval` generations the grid is copied into a second buffer
+// right after swap_cells() and a background thread writes it to
+// <prefix>.<n>.ckpt, rotating over `keep` files. If the previous checkpoint
+// is still being written the new one is skipped, the simulation never waits.
+class Checkpointer
+{
+public:
+  struct Config
+  {
+    std::string prefix = "gol";
+    u64 interval = 0;
+    usz keep = 3;
+    i32 width = 0, height = 0;
+  };
+
+  explicit Checkpointer(Config const& config)
+  : m_config{config}
+  , m_cells(usz(config.width) * config.height)
+  , m_ages(usz(config.width) * config.height)
+  , m_slot{firstSlot(config)}
+  , m_thread([this] { writerLoop(); })
+  { }
+
+  Checkpointer(const Checkpointer&) = delete;
+  Checkpointer& operator=(const Checkpointer&) = delete;
+
+  ~Checkpointer()
+  {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+  }
+
+  // call once per generation, the common case is a single modulo
+  void onGeneration(u64 generation, i8 const* cells, i8 const* ages)
+  {
+    if (!m_config.interval || generation % m_config.interval)
+      return;
+    if (m_busy.load(std::memory_order_acquire))
+    {
+      m_skipped++;
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    memcpy(m_cells.data(), cells, m_cells.size());
+    memcpy(m_ages.data(), ages, m_ages.size());
+    m_copyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    m_copies++;
+
+    {
+      std::lock_guard lock(m_mutex);
+      m_generation = generation;
+      m_busy.store(true, std::memory_order_release);
+    }
+    m_wake.notify_one();
+  }
+
+  static bool restore(char const* path, i32 width, i32 height, u64& generation, i8* cells, i8* ages)
+  {
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+      std::println(stderr, "Checkpointer: could not open {}", path);
+      return false;
+    }
+    Header header;
+    usz const count = usz(width) * height;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1
+           && memcmp(header.magic, Magic, sizeof(Magic)) == 0
+           && header.width == u32(width) && header.height == u32(height)
+           && fread(cells, 1, count, file) == count
+           && fread(ages, 1, count, file) == count;
+    fclose(file);
+    if (!ok)
+    {
+      std::println(stderr, "Checkpointer: {} is not a {}x{} checkpoint", path, width, height);
+      return false;
+    }
+    generation = header.generation;
+    return true;
+  }
+
+  u64 copies()  const { return m_copies; }
+  u64 written() const { return m_written; }
+  u64 skipped() const { return m_skipped; }
+  // total time the simulation thread spent taking snapshots
+  u64 copyNanoseconds() const { return m_copyNanoseconds; }
+
+private:
+  static constexpr char Magic[8] = {'G', 'O', 'L', 'C', 'K', 'P', 'T', '1'};
+
+  struct Header
+  {
+    char magic[8];
+    u32 width, height;
+    u64 generation;
+  };
+
+  static std::string path(Config const& config, usz slot)
+  {
+    return config.prefix + "." + std::to_string(slot) + ".ckpt";
+  }
+
+  // the slot after the newest checkpoint a previous run left, so a restart
+  // (or the --resume source) is never the first file overwritten
+  static usz firstSlot(Config const& config)
+  {
+    usz const keep = std::max<usz>(config.keep, 1);
+    usz slot = 0;
+    u64 newest = 0;
+    bool found = false;
+    for (usz i = 0; i < keep; ++i)
+    {
+      FILE* file = fopen(path(config, i).c_str(), "rb");
+      if (!file)
+        continue;
+      Header header;
+      if (fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, Magic, sizeof(Magic)) == 0
+          && (!found || header.generation > newest))
+      {
+        found = true;
+        newest = header.generation;
+        slot = (i + 1) % keep;
+      }
+      fclose(file);
+    }
+    return slot;
+  }
+
+  void writerLoop()
+  {
+    TRACE_THREAD("checkpointer");
+    for (;;)
+    {
+      u64 generation;
+      {
+        std::unique_lock lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stopping || m_busy.load(std::memory_order_relaxed); });
+        if (!m_busy.load(std::memory_order_relaxed))
+          return;
+        generation = m_generation;
+      }
+      TRACE_SCOPE("write checkpoint");
+      if (write(generation))
+        m_written++;
+      m_busy.store(false, std::memory_order_release);
+    }
+  }
+
+  bool write(u64 generation)
+  {
+    std::string const target = path(m_config, m_slot);
+    std::string const temporary = m_config.prefix + ".ckpt.tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+      std::println(stderr, "Checkpointer: could not open {}", temporary);
+      return false;
+    }
+    Header header{.width = u32(m_config.width), .height = u32(m_config.height), .generation = generation};
+    memcpy(header.magic, Magic, sizeof(Magic));
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+           && fwrite(m_cells.data(), 1, m_cells.size(), file) == m_cells.size()
+           && fwrite(m_ages.data(), 1, m_ages.size(), file) == m_ages.size();
+    ok = fclose(file) == 0 && ok;
+
+    // a crash while writing leaves the previous checkpoints untouched
+    std::error_code error;
+    if (ok)
+      std::filesystem::rename(temporary, target, error);
+    if (!ok || error)
+    {
+      std::println(stderr, "Checkpointer: could not write {}", target);
+      return false;
+    }
+    m_slot = (m_slot + 1) % std::max<usz>(m_config.keep, 1);
+    return true;
+  }
+
+  Config m_config;
+  std::vector<i8> m_cells;
+  std::vector<i8> m_ages;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::atomic<bool> m_busy = false;
+  bool m_stopping = false;
+  u64 m_generation = 0;
+  u64 m_copies = 0;
+  u64 m_skipped = 0;
+  u64 m_copyNanoseconds = 0;
+  std::atomic<u64> m_written = 0;
+  // writer thread only
+  usz m_slot;
+  std::thread m_thread;
+};
+
+#endif // CHECKPOINTER_HPP_
@@ -0,0 +1,326 @@
+//
+// FrameExporter.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef FRAMEEXPORTER_HPP_
+#define FRAMEEXPORTER_HPP_
+
+#include <MyTypes.hpp>
+#include <Math.hpp>
+#include <print>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+#include "Palette.hpp"
+#include "Trace.hpp"
+
+// Writes cell ages as an image sequence (<prefix>_000000.ppm, ...).
+// submit() only copies the ages into a free slot of a fixed ring, the palette
+// lookup and the file writing happen on the encoder threads.
+// Depends on nothing but the standard library so it works without a GPU.
+class FrameExporter
+{
+public:
+  enum class Format { PPM, PNG };
+  // what submit() does when every slot is still waiting for an encoder
+  enum class Policy { Drop, Block };
+
+  struct Config
+  {
+    std::string prefix = "frame";
+    Format format = Format::PPM;
+    Policy policy = Policy::Drop;
+    usz slots = 4;
+    usz threads = 2;
+    // number of the first file, a later recording with the same prefix
+    // continues after the previous one instead of overwriting it
+    u64 first_index = 0;
+  };
+
+  explicit FrameExporter(Config const& config)
+  : m_config{config}
+  , m_slots(std::max<usz>(config.slots, 1))
+  , m_nextIndex{config.first_index}
+  {
+    for (Slot& slot : m_slots)
+      m_free.push_back(&slot);
+    for (usz i = 0, count = std::max<usz>(config.threads, 1); i < count; ++i)
+      m_threads.emplace_back([this] { encoderLoop(); });
+  }
+
+  FrameExporter(const FrameExporter&) = delete;
+  FrameExporter& operator=(const FrameExporter&) = delete;
+
+  ~FrameExporter()
+  {
+    finish();
+  }
+
+  // pending frames are still written before the threads are joined
+  void finish()
+  {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stopping = true;
+    }
+    m_hasReady.notify_all();
+    for (std::thread& thread : m_threads)
+      thread.join();
+    m_threads.clear();
+  }
+
+  // copies rect out of a row major grid of ages that is grid_width cells wide
+  // returns false if the frame was dropped
+  bool submit(i8 const* ages, i32 grid_width, math::iRect const& rect)
+  {
+    return submitRows(rect, [&](i8* row, i32 y) {
+      memcpy(row, ages + rect.x + static_cast<usz>(rect.y + y) * grid_width, rect.w);
+    });
+  }
+
+  // the same from the packed render format, two palette::PackedLevel
+  // nibbles per byte, every level exported as the age it is drawn as
+  bool submitPacked(u8 const* packed, i32 grid_width, math::iRect const& rect)
+  {
+    return submitRows(rect, [&](i8* row, i32 y) {
+      usz const first = rect.x + static_cast<usz>(rect.y + y) * grid_width;
+      for (i32 x = 0; x < rect.w; ++x)
+      {
+        usz const i = first + x;
+        row[x] = palette::PackedAge[(packed[i / 2] >> ((i & 1) * 4)) & 0xf];
+      }
+    });
+  }
+
+  u64 submitted() const { return m_nextIndex - m_config.first_index; }
+  // number of the file the next submitted frame goes to
+  u64 nextIndex() const { return m_nextIndex; }
+  u64 written()   const { return m_written; }
+  u64 dropped()   const { return m_dropped; }
+  std::string const& prefix() const { return m_config.prefix; }
+
+private:
+  struct Slot
+  {
+    std::vector<i8> ages;
+    i32 width = 0, height = 0;
+    u64 index = 0;
+  };
+
+  // fill(row, y) writes row y of rect into the slot
+  template <typename Fill>
+  bool submitRows(math::iRect const& rect, Fill&& fill)
+  {
+    Slot* slot = nullptr;
+    {
+      std::unique_lock lock(m_mutex);
+      if (m_free.empty())
+      {
+        if (m_config.policy == Policy::Drop)
+        {
+          m_dropped++;
+          return false;
+        }
+        m_hasFree.wait(lock, [this] { return !m_free.empty(); });
+      }
+      slot = m_free.front();
+      m_free.pop_front();
+      slot->index = m_nextIndex++;
+    }
+
+    slot->width = rect.w;
+    slot->height = rect.h;
+    slot->ages.resize(static_cast<usz>(rect.w) * rect.h);
+    for (i32 y = 0; y < rect.h; ++y)
+      fill(slot->ages.data() + static_cast<usz>(y) * rect.w, y);
+
+    {
+      std::lock_guard lock(m_mutex);
+      m_ready.push_back(slot);
+    }
+    m_hasReady.notify_one();
+    return true;
+  }
+
+  void encoderLoop()
+  {
+    TRACE_THREAD("exporter");
+    std::vector<u8> rgb;
+    for (;;)
+    {
+      Slot* slot = nullptr;
+      {
+        std::unique_lock lock(m_mutex);
+        m_hasReady.wait(lock, [this] { return m_stopping || !m_ready.empty(); });
+        if (m_ready.empty())
+          return;
+        slot = m_ready.front();
+        m_ready.pop_front();
+      }
+
+      TRACE_SCOPE("encode frame");
+      rgb.resize(slot->ages.size() * 3);
+      for (usz i = 0, count = slot->ages.size(); i < count; ++i)
+      {
+        auto const& color = palette::RGBA8[std::clamp<i32>(slot->ages[i], 0, palette::Count - 1)];
+        memcpy(&rgb[i * 3], color.data(), 3);
+      }
+      i32 const width = slot->width, height = slot->height;
+      u64 const index = slot->index;
+
+      // the copy is done, hand the slot back before touching the disk
+      {
+        std::lock_guard lock(m_mutex);
+        m_free.push_back(slot);
+      }
+      m_hasFree.notify_one();
+
+      bool const ok = m_config.format == Format::PNG
+        ? writePNG(fileName(index, "png"), rgb, width, height)
+        : writePPM(fileName(index, "ppm"), rgb, width, height);
+      if (ok)
+        m_written++;
+    }
+  }
+
+  std::string fileName(u64 index, char const* extension) const
+  {
+    char number[32];
+    snprintf(number, sizeof(number), "_%06llu.", static_cast<unsigned long long>(index));
+    return m_config.prefix + number + extension;
+  }
+
+  static bool writePPM(std::string const& path, std::vector<u8> const& rgb, i32 width, i32 height)
+  {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+      std::println(stderr, "FrameExporter: could not open {}", path);
+      return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    bool ok = fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    return fclose(file) == 0 && ok;
+  }
+
+  // uncompressed png, the deflate stream only uses stored blocks so no zlib is needed
+  static bool writePNG(std::string const& path, std::vector<u8> const& rgb, i32 width, i32 height)
+  {
+    std::vector<u8> raw;
+    usz const stride = static_cast<usz>(width) * 3;
+    raw.reserve((stride + 1) * height);
+    for (i32 y = 0; y < height; ++y)
+    {
+      raw.push_back(0); // filter: none
+      raw.insert(raw.end(), rgb.begin() + y * stride, rgb.begin() + (y + 1) * stride);
+    }
+
+    std::vector<u8> zlib = {0x78, 0x01};
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    usz offset = 0;
+    do
+    {
+      u16 const length = static_cast<u16>(std::min<usz>(raw.size() - offset, 65535));
+      bool const last = offset + length == raw.size();
+      zlib.push_back(last ? 1 : 0);
+      zlib.push_back(length & 0xff);
+      zlib.push_back(length >> 8);
+      zlib.push_back(~length & 0xff);
+      zlib.push_back((~length >> 8) & 0xff);
+      zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+      offset += length;
+    } while (offset < raw.size());
+    putBigEndian(zlib, adler32(raw));
+
+    std::vector<u8> header;
+    putBigEndian(header, width);
+    putBigEndian(header, height);
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bit rgb
+
+    std::vector<u8> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    putChunk(png, "IHDR", header);
+    putChunk(png, "IDAT", zlib);
+    putChunk(png, "IEND", {});
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+      std::println(stderr, "FrameExporter: could not open {}", path);
+      return false;
+    }
+    bool ok = fwrite(png.data(), 1, png.size(), file) == png.size();
+    return fclose(file) == 0 && ok;
+  }
+
+  static void putBigEndian(std::vector<u8>& out, u32 value)
+  {
+    out.insert(out.end(), {u8(value >> 24), u8(value >> 16), u8(value >> 8), u8(value)});
+  }
+
+  static void putChunk(std::vector<u8>& out, char const (&type)[5], std::vector<u8> const& data)
+  {
+    putBigEndian(out, data.size());
+    usz const start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBigEndian(out, crc32(out.data() + start, out.size() - start));
+  }
+
+  static u32 crc32(u8 const* data, usz size)
+  {
+    static constexpr auto Table = [] {
+      std::array<u32, 256> table{};
+      for (u32 n = 0; n < 256; ++n)
+      {
+        u32 c = n;
+        for (int k = 0; k < 8; ++k)
+          c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        table[n] = c;
+      }
+      return table;
+    }();
+    u32 crc = 0xffffffffu;
+    for (usz i = 0; i < size; ++i)
+      crc = Table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+  }
+
+  static u32 adler32(std::vector<u8> const& data)
+  {
+    u32 a = 1, b = 0;
+    for (u8 byte : data)
+    {
+      a = (a + byte) % 65521;
+      b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+  }
+
+  Config m_config;
+  std::vector<Slot> m_slots;
+  std::deque<Slot*> m_free;
+  std::deque<Slot*> m_ready;
+  std::mutex m_mutex;
+  std::condition_variable m_hasReady;
+  std::condition_variable m_hasFree;
+  std::vector<std::thread> m_threads;
+  bool m_stopping = false;
+  u64 m_nextIndex = 0;
+  std::atomic<u64> m_written = 0;
+  std::atomic<u64> m_dropped = 0;
+};
+
+#endif // FRAMEEXPORTER_HPP_
@@ -0,0 +1,86 @@
+//
+// Histogram.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef HISTOGRAM_HPP_
+#define HISTOGRAM_HPP_
+
+#include <MyTypes.hpp>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+// Log-linear latency histogram in the spirit of HdrHistogram: every power of
+// two is split in 2^(SubBits - 1) linear buckets, so any recorded value is
+// reported within about 3% over the whole u64 range with a fixed 8 KB table.
+// One thread records, any thread may read; counters are relaxed atomics so
+// a report taken while recording is merely slightly stale.
+class Histogram
+{
+public:
+  static constexpr u32 SubBits = 5;
+  static constexpr usz Buckets = usz(66 - SubBits) << (SubBits - 1);
+
+  void record(u64 value)
+  {
+    bump(m_counts[index(value)]);
+    bump(m_count);
+    if (value > m_max.load(std::memory_order_relaxed))
+      m_max.store(value, std::memory_order_relaxed);
+  }
+
+  u64 count() const { return m_count.load(std::memory_order_relaxed); }
+  u64 max()   const { return m_max.load(std::memory_order_relaxed); }
+
+  // smallest value with at least `quantile` of the records at or below it
+  u64 percentile(f64 quantile) const
+  {
+    u64 const total = count();
+    if (!total)
+      return 0;
+    u64 const rank = std::max<u64>(1, u64(std::ceil(quantile * total)));
+    u64 seen = 0;
+    for (usz i = 0; i < Buckets; ++i)
+    {
+      seen += m_counts[i].load(std::memory_order_relaxed);
+      if (seen >= rank)
+        return std::min(highestEquivalent(i), max());
+    }
+    return max();
+  }
+
+private:
+  static void bump(std::atomic<u64>& counter)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  static usz index(u64 value)
+  {
+    if (value < (u64(1) << SubBits))
+      return value;
+    u32 const bucket = std::bit_width(value) - SubBits;
+    return (usz(bucket) << (SubBits - 1)) + (value >> bucket);
+  }
+
+  // largest value that lands in bucket i
+  static u64 highestEquivalent(usz i)
+  {
+    if (i < (usz(1) << SubBits))
+      return i;
+    u32 const bucket = (i >> (SubBits - 1)) - 1;
+    u64 const sub = i - (usz(bucket) << (SubBits - 1));
+    return (sub << bucket) + ((u64(1) << bucket) - 1);
+  }
+
+  std::atomic<u64> m_counts[Buckets] = {};
+  std::atomic<u64> m_count = 0;
+  std::atomic<u64> m_max = 0;
+};
+
+#endif // HISTOGRAM_HPP_
@@ -0,0 +1,294 @@
+//
+// History.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef HISTORY_HPP_
+#define HISTORY_HPP_
+
+#include <MyTypes.hpp>
+#include <vector>
+#include <deque>
+#include <array>
+#include <algorithm>
+#include <cstring>
+
+// Bounded record of the last generations for rewinding.
+// Cells are bit packed (one bit per cell) and every generation stores the xor
+// against the previous one, run length encoded over 64 bit words. Every
+// `keyframe_interval` generations, and after any edit, a keyframe with the
+// packed cells and the ages is stored instead, run length encoded unless
+// that is not smaller than one byte per cell (a soup), then as they are.
+// Ages are never stored for deltas: every delta keeps the fade count its
+// generation was stepped with, and replaying the deltas forward from a
+// keyframe recomputes the ages with the same fade rule as the step kernel.
+// A fade count of 0 (cells only) leaves the ages as they were, like the step.
+// When the budget is exceeded whole keyframe groups are dropped from the front.
+class History
+{
+public:
+  struct Config
+  {
+    usz keyframe_interval = 16;
+    usz budget_bytes = usz(256) << 20;
+  };
+
+  History(Config const& config, usz cell_count)
+  : m_config{config}
+  , m_count{cell_count}
+  , m_previous((cell_count + 63) / 64)
+  , m_scratch((cell_count + 63) / 64)
+  { }
+
+  // called with the state of every generation and the fade count it was
+  // stepped with, edits in between must call markEdited()
+  void record(u64 generation, i8 const* cells, i8 const* ages, i32 fade = 1)
+  {
+    // stepping forward again after a rewind replaces the old future
+    while (!m_entries.empty() && m_entries.back().generation >= generation)
+      popBack();
+
+    pack(cells, m_scratch);
+    bool const keyframe = m_edited || m_entries.empty()
+                       || m_entries.back().generation + 1 != generation
+                       || m_sinceKeyframe + 1 >= m_config.keyframe_interval;
+    Entry entry{.generation = generation, .keyframe = keyframe, .fade = u8(std::clamp(fade, 0, 21))};
+    if (keyframe)
+    {
+      encodeWords(m_scratch, nullptr, entry.cells);
+      encodeAges(ages, entry.ages);
+      m_sinceKeyframe = 0;
+    }
+    else
+    {
+      encodeWords(m_scratch, &m_previous, entry.cells);
+      m_sinceKeyframe++;
+    }
+    std::swap(m_previous, m_scratch);
+    m_edited = false;
+
+    m_bytes += entry.bytes();
+    m_keyframes += keyframe;
+    m_entries.push_back(std::move(entry));
+    while (m_bytes > m_config.budget_bytes && m_keyframes > 1)
+      popFrontGroup();
+  }
+
+  // cells or ages changed outside of a step, the next record is a keyframe
+  void markEdited() { m_edited = true; }
+
+  bool empty() const { return m_entries.empty(); }
+  u64 oldest() const { return m_entries.front().generation; }
+  u64 newest() const { return m_entries.back().generation; }
+  usz bytes() const { return m_bytes; }
+
+  // rebuilds cells (0/1) and ages of a generation inside [oldest, newest]
+  bool restore(u64 generation, i8* cells, i8* ages)
+  {
+    if (m_entries.empty() || generation < oldest() || generation > newest())
+      return false;
+    usz target = generation - oldest();
+    usz start = target;
+    while (!m_entries[start].keyframe)
+      --start;
+
+    std::vector<u64>& packed = m_scratch;
+    std::fill(packed.begin(), packed.end(), 0);
+    decodeWords(m_entries[start].cells, packed, nullptr, 0);
+    decodeAges(m_entries[start].ages, ages);
+    for (usz i = start + 1; i <= target; ++i)
+      decodeWords(m_entries[i].cells, packed, ages, m_entries[i].fade);
+    unpack(packed, cells);
+
+    // the next record continues from here
+    std::swap(m_previous, m_scratch);
+    m_sinceKeyframe = target - start;
+    return true;
+  }
+
+private:
+  struct Entry
+  {
+    u64 generation;
+    bool keyframe;
+    u8 fade;
+    std::vector<u64> cells;
+    std::vector<u8> ages;
+    usz bytes() const { return sizeof(Entry) + cells.size() * sizeof(u64) + ages.size(); }
+  };
+
+  void popBack()
+  {
+    m_bytes -= m_entries.back().bytes();
+    m_keyframes -= m_entries.back().keyframe;
+    m_entries.pop_back();
+    m_edited = true;
+  }
+
+  void popFrontGroup()
+  {
+    do
+    {
+      m_bytes -= m_entries.front().bytes();
+      m_keyframes -= m_entries.front().keyframe;
+      m_entries.pop_front();
+    } while (!m_entries.empty() && !m_entries.front().keyframe);
+  }
+
+  // 8 bytes holding 0 or 1 become 8 bits in one multiply
+  void pack(i8 const* cells, std::vector<u64>& packed) const
+  {
+    usz const full = m_count / 64;
+    for (usz w = 0; w < full; ++w)
+    {
+      u64 word = 0;
+      for (usz b = 0; b < 8; ++b)
+      {
+        u64 bytes;
+        memcpy(&bytes, cells + w * 64 + b * 8, 8);
+        word |= ((bytes * 0x0102040810204080ull) >> 56) << (b * 8);
+      }
+      packed[w] = word;
+    }
+    if (full < packed.size())
+    {
+      u64 word = 0;
+      for (usz i = full * 64; i < m_count; ++i)
+        word |= u64(cells[i] & 1) << (i % 64);
+      packed[full] = word;
+    }
+  }
+
+  void unpack(std::vector<u64> const& packed, i8* cells) const
+  {
+    static constexpr auto Spread = [] {
+      std::array<u64, 256> table{};
+      for (u32 m = 0; m < 256; ++m)
+        for (u32 b = 0; b < 8; ++b)
+          table[m] |= u64((m >> b) & 1) << (b * 8);
+      return table;
+    }();
+    usz const full = m_count / 64;
+    for (usz w = 0; w < full; ++w)
+      for (usz b = 0; b < 8; ++b)
+        memcpy(cells + w * 64 + b * 8, &Spread[(packed[w] >> (b * 8)) & 0xff], 8);
+    for (usz i = full * 64; i < m_count; ++i)
+      cells[i] = (packed[full] >> (i % 64)) & 1;
+  }
+
+  // stream of [zero words << 32 | literal words] headers, each followed by its literals
+  static void encodeWords(std::vector<u64> const& words, std::vector<u64> const* base, std::vector<u64>& out)
+  {
+    usz i = 0, count = words.size();
+    auto at = [&](usz k) { return base ? words[k] ^ (*base)[k] : words[k]; };
+    while (i < count)
+    {
+      usz zeros = 0;
+      while (i + zeros < count && !at(i + zeros) && zeros < 0xffffffffu)
+        ++zeros;
+      usz literals = 0;
+      while (i + zeros + literals < count && at(i + zeros + literals) && literals < 0xffffffffu)
+        ++literals;
+      out.push_back((u64(zeros) << 32) | literals);
+      for (usz k = 0; k < literals; ++k)
+        out.push_back(at(i + zeros + k));
+      i += zeros + literals;
+    }
+  }
+
+  // xors a stream into packed, when ages is set they are advanced one generation faded by fade
+  void decodeWords(std::vector<u64> const& stream, std::vector<u64>& packed, i8* ages, i32 fade) const
+  {
+    if (!fade)
+      ages = nullptr;
+    usz w = 0;
+    for (usz s = 0; s < stream.size();)
+    {
+      u64 header = stream[s++];
+      usz zeros = header >> 32, literals = header & 0xffffffffu;
+      if (ages)
+        for (usz k = 0; k < zeros; ++k, ++w)
+          fadeWord(w, packed[w], packed[w], ages, fade);
+      else
+        w += zeros;
+      for (usz k = 0; k < literals; ++k, ++w)
+      {
+        u64 const before = packed[w];
+        packed[w] ^= stream[s++];
+        if (ages)
+          fadeWord(w, before, packed[w], ages, fade);
+      }
+    }
+    if (ages)
+      for (; w < packed.size(); ++w)
+        fadeWord(w, packed[w], packed[w], ages, fade);
+  }
+
+  // same rule as applyRuleRows, ages still 21 on a dead cell were last
+  // faded while it was alive
+  void fadeWord(usz w, u64 before, u64 after, i8* ages, i32 fade) const
+  {
+    usz const first = w * 64, last = std::min(first + 64, m_count);
+    i8* age = ages + first;
+    auto const dead = [fade](i8 age) { return i8(age == 21 ? std::min(20, fade - 1) : std::min(20, age + fade)); };
+    if (!(before | after))
+    {
+      for (usz i = first; i < last; ++i, ++age)
+        *age = dead(*age);
+      return;
+    }
+    for (usz i = first, b = 0; i < last; ++i, ++b, ++age)
+    {
+      bool const was = (before >> b) & 1, is = (after >> b) & 1;
+      *age = is ? 21 : was ? 0 : dead(*age);
+    }
+  }
+
+  // [value, run - 1] pairs, or the ages as they are when the pairs would
+  // take a byte per cell or more
+  void encodeAges(i8 const* ages, std::vector<u8>& out) const
+  {
+    for (usz i = 0; i < m_count && out.size() < m_count;)
+    {
+      usz run = 1;
+      while (i + run < m_count && run < 256 && ages[i + run] == ages[i])
+        ++run;
+      out.push_back(u8(ages[i]));
+      out.push_back(u8(run - 1));
+      i += run;
+    }
+    if (out.size() >= m_count)
+      out.assign(reinterpret_cast<u8 const*>(ages), reinterpret_cast<u8 const*>(ages) + m_count);
+    out.shrink_to_fit();
+  }
+
+  void decodeAges(std::vector<u8> const& stream, i8* ages) const
+  {
+    if (stream.size() == m_count)
+    {
+      memcpy(ages, stream.data(), m_count);
+      return;
+    }
+    for (usz s = 0; s < stream.size(); s += 2)
+    {
+      usz const run = usz(stream[s + 1]) + 1;
+      memset(ages, stream[s], run);
+      ages += run;
+    }
+  }
+
+  Config m_config;
+  usz m_count;
+  std::deque<Entry> m_entries;
+  std::vector<u64> m_previous;
+  std::vector<u64> m_scratch;
+  usz m_bytes = 0;
+  usz m_keyframes = 0;
+  usz m_sinceKeyframe = 0;
+  bool m_edited = true;
+};
+
+#endif // HISTORY_HPP_
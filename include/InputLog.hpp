@@ -0,0 +1,260 @@
+//
+// InputLog.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef INPUTLOG_HPP_
+#define INPUTLOG_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+
+// Everything a session depends on besides the hardware, as a text file:
+//   gol-input 1
+//   seed <seed>
+//   size <width> <height> <fullscreen>
+//   frame <iteration> <key bits> <mouse x> <mouse y> <mouse buttons>
+//   key <iteration> <keycode> <modifiers> <repeat>
+//   window <iteration> <width> <height> <fullscreen>
+//   step <input commands> <stepped> <unshown generations>
+// size is the window the session started with. Frames, keys and windows
+// are written by the render thread, one line per iteration and per key
+// press or window size change that arrived before it: the window size
+// places the camera, and with it where a click lands on the grid. Steps
+// are written by the simulation thread, one per pass of its loop: how many
+// input commands it ran, whether it stepped after them and how the
+// generations were batched, which is all the clock decided. Replaying all
+// of them gives the same grid every generation.
+class InputLog
+{
+public:
+  struct Frame
+  {
+    u32 keys = 0;
+    f32 mouse_x = 0, mouse_y = 0;
+    u32 buttons = 0;
+  };
+
+  struct Key
+  {
+    u64 iteration;
+    u32 key, mod;
+    bool repeat;
+  };
+
+  // window size in screen coordinates, not pixels
+  struct Window
+  {
+    u64 iteration = 0;
+    i32 width = 0, height = 0;
+    bool fullscreen = false;
+
+    bool sameSize(Window const& other) const
+    {
+      return width == other.width && height == other.height && fullscreen == other.fullscreen;
+    }
+  };
+
+  struct Step
+  {
+    u64 commands = 0;
+    bool stepped = false;
+    i32 skipped = 0;
+  };
+
+  static std::unique_ptr<InputLog> record(char const* path, u32 seed)
+  {
+    std::unique_ptr<InputLog> log(new InputLog);
+    log->m_file = fopen(path, "w");
+    if (!log->m_file)
+    {
+      std::println(stderr, "InputLog: could not open {}", path);
+      return nullptr;
+    }
+    log->m_seed = seed;
+    std::println(log->m_file, "gol-input 1\nseed {}", seed);
+    return log;
+  }
+
+  static std::unique_ptr<InputLog> replay(char const* path)
+  {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != "gol-input 1")
+    {
+      std::println(stderr, "InputLog: {} is not an input log", path);
+      return nullptr;
+    }
+    std::unique_ptr<InputLog> log(new InputLog);
+    log->m_replaying = true;
+    while (std::getline(file, line))
+    {
+      std::istringstream in(line);
+      std::string kind;
+      in >> kind;
+      bool ok = true;
+      if (kind == "seed")
+        ok = bool(in >> log->m_seed);
+      else if (kind == "size")
+      {
+        Window& size = log->m_size;
+        ok = bool(in >> size.width >> size.height >> size.fullscreen);
+      }
+      else if (kind == "frame")
+      {
+        u64 iteration;
+        Frame frame;
+        ok = bool(in >> iteration >> frame.keys >> frame.mouse_x >> frame.mouse_y >> frame.buttons)
+          && iteration == log->m_frames.size();
+        log->m_frames.push_back(frame);
+      }
+      else if (kind == "key")
+      {
+        Key key;
+        ok = bool(in >> key.iteration >> key.key >> key.mod >> key.repeat);
+        log->m_events.push_back({key.iteration, false, log->m_keys.size()});
+        log->m_keys.push_back(key);
+      }
+      else if (kind == "window")
+      {
+        Window window;
+        ok = bool(in >> window.iteration >> window.width >> window.height >> window.fullscreen);
+        log->m_events.push_back({window.iteration, true, log->m_windows.size()});
+        log->m_windows.push_back(window);
+      }
+      else if (kind == "step")
+      {
+        Step step;
+        ok = bool(in >> step.commands >> step.stepped >> step.skipped);
+        log->m_steps.push_back(step);
+      }
+      if (!ok)
+      {
+        std::println(stderr, "InputLog: {}: bad line \"{}\"", path, line);
+        return nullptr;
+      }
+    }
+    return log;
+  }
+
+  InputLog(const InputLog&) = delete;
+  InputLog& operator=(const InputLog&) = delete;
+
+  ~InputLog()
+  {
+    if (m_file)
+      fclose(m_file);
+  }
+
+  bool replaying() const { return m_replaying; }
+  u32 seed() const { return m_seed; }
+
+  void logFrame(u64 iteration, Frame const& frame)
+  {
+    std::lock_guard lock(m_mutex);
+    std::println(m_file, "frame {} {} {} {} {}", iteration, frame.keys, frame.mouse_x, frame.mouse_y, frame.buttons);
+  }
+
+  void logKey(Key const& key)
+  {
+    std::lock_guard lock(m_mutex);
+    std::println(m_file, "key {} {} {} {}", key.iteration, key.key, key.mod, int(key.repeat));
+  }
+
+  // once, before the first frame
+  void logSize(Window const& size)
+  {
+    std::lock_guard lock(m_mutex);
+    std::println(m_file, "size {} {} {}", size.width, size.height, int(size.fullscreen));
+    m_lastWindow = size;
+  }
+
+  // a resize sends more than one event, only changes are written
+  void logWindow(Window const& window)
+  {
+    std::lock_guard lock(m_mutex);
+    if (window.sameSize(m_lastWindow))
+      return;
+    std::println(m_file, "window {} {} {} {}", window.iteration, window.width, window.height, int(window.fullscreen));
+    m_lastWindow = window;
+  }
+
+  void logStep(Step const& step)
+  {
+    std::lock_guard lock(m_mutex);
+    std::println(m_file, "step {} {} {}", step.commands, int(step.stepped), step.skipped);
+  }
+
+  // replay, render thread
+  u64 frameCount() const { return m_frames.size(); }
+  Frame const& frame(u64 iteration) const { return m_frames[iteration]; }
+
+  // replay: the starting window, false for logs without one
+  bool startSize(Window& size) const
+  {
+    if (!m_size.width || !m_size.height)
+      return false;
+    size = m_size;
+    return true;
+  }
+
+  // replay, render thread: the key presses and window changes that arrived
+  // before iteration, in the order they arrived
+  template <typename K, typename W>
+  void eventsBefore(u64 iteration, K&& handleKey, W&& handleWindow)
+  {
+    for (; m_nextEvent < m_events.size() && m_events[m_nextEvent].iteration <= iteration; ++m_nextEvent)
+    {
+      Event const& event = m_events[m_nextEvent];
+      if (event.window)
+        handleWindow(m_windows[event.index]);
+      else
+        handleKey(m_keys[event.index]);
+    }
+  }
+
+  // replay, simulation thread
+  bool nextStep(Step& step)
+  {
+    if (m_nextStep == m_steps.size())
+      return false;
+    step = m_steps[m_nextStep++];
+    return true;
+  }
+
+private:
+  struct Event
+  {
+    u64 iteration;
+    bool window;
+    usz index;
+  };
+
+  InputLog() = default;
+
+  FILE* m_file = nullptr;
+  std::mutex m_mutex;
+  bool m_replaying = false;
+  u32 m_seed = 0;
+  std::vector<Frame> m_frames;
+  Window m_size;
+  Window m_lastWindow;
+  std::vector<Key> m_keys;
+  std::vector<Window> m_windows;
+  std::vector<Event> m_events;
+  std::vector<Step> m_steps;
+  usz m_nextEvent = 0;
+  usz m_nextStep = 0;
+};
+
+#endif // INPUTLOG_HPP_
@@ -0,0 +1,321 @@
+//
+// Life.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef LIFE_HPP_
+#define LIFE_HPP_
+
+#include <MyTypes.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#include "Palette.hpp"
+
+// B3/S23 on a torus, cells are 0 or 1 and ages index the shader palette:
+// 21 alive, 0 just died, then fading up to 20 (background)
+namespace life
+{
+
+// what one generation did to the grid
+struct Counts
+{
+  u64 population = 0;
+  u64 births = 0;
+  u64 deaths = 0;
+};
+
+struct Output
+{
+  // faded in place
+  i8* ages;
+  // one byte per row, or'ed with 1 when any age of the row changed
+  u8* dirty_rows = nullptr;
+  // optional render copy, two palette::PackedLevel nibbles per byte,
+  // the even cell in the low nibble. Needs an even grid width.
+  u8* packed = nullptr;
+  // generations since the ages were last faded, more than 1 when the ones
+  // in between went through stepCells(). A cell that was alive then but is
+  // dead now is aged as if it died right after.
+  i32 fade_generations = 1;
+  // optional, receives every row of what the renderer reads (the packed
+  // copy when packed is set, otherwise the ages) right after the row is
+  // computed, so nobody has to copy the whole buffer afterwards
+  u8* render = nullptr;
+  // optional, overwritten with the counts of the generation
+  Counts* counts = nullptr;
+};
+
+// copies a row without pulling the destination into the cache
+inline void streamRow(u8* dst, u8 const* src, usz bytes)
+{
+  usz i = 0;
+#if defined(__SSE2__)
+  if ((uintptr_t(dst) & 15) == 0)
+    for (; i + 16 <= bytes; i += 16)
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)));
+#endif
+  memcpy(dst + i, src + i, bytes - i);
+}
+
+// fills the packed render copy of rows [first, last) from the ages
+inline void packRows(i8 const* ages, u8* packed, i32 gridWidth, i32 first, i32 last)
+{
+  for (usz i = usz(first) * gridWidth, end = usz(last) * gridWidth; i < end; i += 2)
+    packed[i / 2] = palette::PackedLevel[ages[i]] | (palette::PackedLevel[ages[i + 1]] << 4);
+}
+
+// writes the neighbour count of every cell of current into next
+inline void countNeighbours(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth, i32 const gridHeight)
+{
+  for (auto y = 1; y < gridHeight - 1; ++y)
+  {
+    for (auto x = 1; x < gridWidth - 1; ++x)
+    {
+      auto cellIndex = x + y * gridWidth;
+                              // east west
+      next_cells[cellIndex] = current_cells[cellIndex + 1]
+                            + current_cells[cellIndex - 1]
+                              // north and south
+                            + current_cells[cellIndex + gridWidth]
+                            + current_cells[cellIndex - gridWidth]
+                              // ne and se
+                            + current_cells[cellIndex + gridWidth + 1]
+                            + current_cells[cellIndex - gridWidth + 1]
+                              // nw and sw
+                            + current_cells[cellIndex + gridWidth - 1]
+                            + current_cells[cellIndex - gridWidth - 1];
+    }
+  }
+
+  for (auto x = 0; x < gridWidth; ++x)
+  {
+    auto nIndex = x, sIndex = x + (gridHeight - 1) * gridWidth, last_row = gridWidth * (gridHeight - 1);
+    auto x_pls_1_mod = (x + 1) % gridWidth;
+    auto x_min_1_mod = (x - 1 + gridWidth) % gridWidth;
+
+    next_cells[nIndex] = current_cells[x_pls_1_mod]
+                       + current_cells[x_min_1_mod]
+
+                       + current_cells[x + gridWidth]
+                       + current_cells[sIndex]
+
+                       + current_cells[x_pls_1_mod + gridWidth]
+                       + current_cells[x_pls_1_mod + last_row]
+
+                       + current_cells[x_min_1_mod + gridWidth]
+                       + current_cells[x_min_1_mod + last_row];
+
+    next_cells[sIndex] = current_cells[x_pls_1_mod + last_row]
+                       + current_cells[x_min_1_mod + last_row]
+
+                       + current_cells[x]
+                       + current_cells[sIndex - gridWidth]
+
+                       + current_cells[x_pls_1_mod]
+                       + current_cells[x_min_1_mod]
+
+                       + current_cells[x_pls_1_mod + gridWidth * (gridHeight - 2)]
+                       + current_cells[x_min_1_mod + gridWidth * (gridHeight - 2)];
+  }
+
+  for (auto y = 1; y < (gridHeight - 1); ++y)
+  {
+    auto eIndex = y * gridWidth, wIndex = eIndex + gridWidth - 1;
+    // north and south
+    next_cells[eIndex] = current_cells[eIndex - gridWidth]
+                       + current_cells[eIndex + gridWidth]
+    // east and west
+                       + current_cells[eIndex + 1]
+                       + current_cells[wIndex]
+    // ne and se
+                       + current_cells[eIndex - gridWidth + 1]
+                       + current_cells[eIndex + gridWidth + 1]
+    // nw and sw
+                       + current_cells[wIndex - gridWidth]
+                       + current_cells[wIndex + gridWidth];
+
+    // north and south
+    next_cells[wIndex] = current_cells[wIndex - gridWidth]
+                       + current_cells[wIndex + gridWidth]
+
+    // east and west
+                       + current_cells[eIndex]
+                       + current_cells[wIndex - 1]
+    // nw and sw
+                       + current_cells[wIndex - gridWidth - 1]
+                       + current_cells[wIndex + gridWidth - 1]
+    // ne and se
+                       + current_cells[eIndex - gridWidth]
+                       + current_cells[eIndex + gridWidth];
+  }
+}
+
+// countNeighbours for rows [first, last) only. Every row wraps through its
+// own neighbours, so the bands of a grid can be counted independently.
+inline void countNeighboursRows(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth,
+                                i32 const gridHeight, i32 const first, i32 const last)
+{
+  for (i32 y = first; y < last; ++y)
+  {
+    i8 const* const north = current_cells + usz((y - 1 + gridHeight) % gridHeight) * gridWidth;
+    i8 const* const row = current_cells + usz(y) * gridWidth;
+    i8 const* const south = current_cells + usz((y + 1) % gridHeight) * gridWidth;
+    i8* const out = next_cells + usz(y) * gridWidth;
+    for (i32 x = 1; x < gridWidth - 1; ++x)
+      out[x] = north[x - 1] + north[x] + north[x + 1]
+             + row[x - 1] + row[x + 1]
+             + south[x - 1] + south[x] + south[x + 1];
+    // the first and last column wrap
+    for (i32 x : {0, gridWidth - 1})
+    {
+      i32 const w = (x - 1 + gridWidth) % gridWidth, e = (x + 1) % gridWidth;
+      out[x] = north[w] + north[x] + north[e]
+             + row[w] + row[e]
+             + south[w] + south[x] + south[e];
+    }
+  }
+}
+
+// applyRule for rows [first, last), adds to counts. Leaves the streaming
+// stores to render unfenced, the caller fences once it is done.
+inline void applyRuleRows(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth,
+                          i32 const first, i32 const last, Output const& output, Counts& counts)
+{
+  i8* const pixels = output.ages;
+  i32 const fade = output.fade_generations;
+  for (i32 y = first; y < last; ++y) {
+    u8 changed = 0;
+    // row sums stay in registers, the counts cost no extra pass
+    u32 population = 0, births = 0, deaths = 0;
+    for (usz i = usz(y) * gridWidth, end = i + gridWidth; i < end; ++i) {
+      auto cc = current_cells[i];
+      i8 sc = next_cells[i];
+      next_cells[i] = 0;
+      i8& result = pixels[i];
+      i8 const before = result;
+      if (cc == 1) {
+        switch (sc) {
+        case 2:
+        case 3:
+          next_cells[i] = 1;
+          result = 21;
+          population++;
+          break;
+        default:
+          result = 0;
+          deaths++;
+          break;
+        }
+      } else {
+        if (sc == 3) {
+          next_cells[i] = 1;
+          result = 21;
+          population++;
+          births++;
+        } else {
+          result = result == 21 ? std::min(20, fade - 1) : std::min(20, result + fade);
+        }
+      }
+      changed |= before != result;
+    }
+    counts.population += population;
+    counts.births += births;
+    counts.deaths += deaths;
+    if (output.dirty_rows)
+      output.dirty_rows[y] |= changed;
+    // still hot in cache
+    if (output.packed && changed)
+      packRows(pixels, output.packed, gridWidth, y, y + 1);
+    if (output.render && output.packed)
+      streamRow(output.render + usz(y) * (gridWidth / 2), output.packed + usz(y) * (gridWidth / 2), gridWidth / 2);
+    else if (output.render)
+      streamRow(output.render + usz(y) * gridWidth, reinterpret_cast<u8 const*>(pixels) + usz(y) * gridWidth, gridWidth);
+  }
+}
+
+// streaming stores are weakly ordered, publish them before the buffer is handed over
+inline void fenceRender(Output const& output)
+{
+#if defined(__SSE2__)
+  if (output.render)
+    _mm_sfence();
+#else
+  (void)output;
+#endif
+}
+
+// turns the counts in next into the next generation and fades the ages
+inline void applyRule(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth, i32 const gridHeight,
+                      Output const& output)
+{
+  Counts counts;
+  applyRuleRows(current_cells, next_cells, gridWidth, 0, gridHeight, output, counts);
+  fenceRender(output);
+  if (output.counts)
+    *output.counts = counts;
+}
+
+// applyRuleCells for rows [first, last), adds to counts when given
+inline void applyRuleCellsRows(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth,
+                               i32 const first, i32 const last, Counts* counts = nullptr)
+{
+  if (!counts)
+  {
+    for (usz i = usz(first) * gridWidth, end = usz(last) * gridWidth; i < end; ++i)
+      next_cells[i] = next_cells[i] == 3 || (next_cells[i] == 2 && current_cells[i] == 1);
+    return;
+  }
+  for (i32 y = first; y < last; ++y)
+  {
+    u32 population = 0, births = 0, deaths = 0;
+    for (usz i = usz(y) * gridWidth, end = i + gridWidth; i < end; ++i)
+    {
+      u8 const before = current_cells[i];
+      u8 const alive = next_cells[i] == 3 || (next_cells[i] == 2 && before == 1);
+      next_cells[i] = alive;
+      population += alive;
+      births += alive & ~before;
+      deaths += before & ~alive;
+    }
+    counts->population += population;
+    counts->births += births;
+    counts->deaths += deaths;
+  }
+}
+
+// the rule alone, for generations that are never shown. The counts are
+// only summed when asked for, without branches so the loop stays vectorized.
+inline void applyRuleCells(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth, i32 const gridHeight,
+                           Counts* counts = nullptr)
+{
+  if (counts)
+    *counts = {};
+  applyRuleCellsRows(current_cells, next_cells, gridWidth, 0, gridHeight, counts);
+}
+
+inline void stepCells(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth, i32 const gridHeight,
+                      Counts* counts = nullptr)
+{
+  countNeighbours(current_cells, next_cells, gridWidth, gridHeight);
+  applyRuleCells(current_cells, next_cells, gridWidth, gridHeight, counts);
+}
+
+inline void step(i8 const* const current_cells, i8* const next_cells, i32 const gridWidth, i32 const gridHeight,
+                 Output const& output)
+{
+  countNeighbours(current_cells, next_cells, gridWidth, gridHeight);
+  applyRule(current_cells, next_cells, gridWidth, gridHeight, output);
+}
+
+} // namespace life
+
+#endif // LIFE_HPP_
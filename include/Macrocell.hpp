@@ -0,0 +1,344 @@
+//
+// Macrocell.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef MACROCELL_HPP_
+#define MACROCELL_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdio>
+
+// Golly macrocell (.mc) universe kept as a deduplicated quadtree.
+// Level 3 nodes are 8x8 leaves stored as a bitmap, bit (x + y * 8),
+// higher levels point to their four quadrants. Index 0 is the empty node
+// of any level, so empty space never costs memory.
+// The root is centered on the origin like in Golly, and the dense grid maps
+// onto it centered as well: cell (x, y) is at (x - width / 2, y - height / 2).
+class Macrocell
+{
+public:
+  static constexpr i32 LeafLevel = 3;
+  // keeps every coordinate inside an i64 while walking the tree
+  static constexpr i32 MaxWalkLevel = 62;
+
+  struct Node
+  {
+    i32 level = 0;
+    u64 bits = 0;
+    u32 nw = 0, ne = 0, sw = 0, se = 0;
+  };
+
+  Macrocell()
+  : m_nodes(1)
+  { }
+
+  i32 level() const { return m_level; }
+  u32 root() const { return m_root; }
+  usz nodeCount() const { return m_nodes.size() - 1; }
+
+  bool load(char const* path)
+  {
+    std::ifstream file(path);
+    if (!file)
+    {
+      std::println(stderr, "Macrocell: could not open {}", path);
+      return false;
+    }
+
+    *this = Macrocell();
+    std::string line;
+    bool header = false;
+    while (std::getline(file, line))
+    {
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (line.empty())
+        continue;
+      if (line.starts_with("[M2]"))
+      {
+        header = true;
+        continue;
+      }
+      if (line[0] == '#')
+      {
+        if (line.starts_with("#R") && line.find("B3/S23") == std::string::npos)
+          std::println(stderr, "Macrocell: {} uses rule '{}', importing as B3/S23", path, line.substr(2));
+        continue;
+      }
+      if (!header)
+      {
+        std::println(stderr, "Macrocell: {} is missing the [M2] header", path);
+        return false;
+      }
+
+      // every node line gets the next index, even duplicates, since later
+      // lines refer to them by line number
+      if (line[0] == '.' || line[0] == '*' || line[0] == '$')
+      {
+        u64 bits = 0;
+        i32 x = 0, y = 0;
+        for (char c : line)
+        {
+          if (c == '$') { x = 0; ++y; continue; }
+          if (x >= 8 || y >= 8)
+            return fail(path, line);
+          if (c == '*')
+            bits |= u64(1) << (x + y * 8);
+          else if (c != '.')
+            return fail(path, line);
+          ++x;
+        }
+        m_lines.push_back(leaf(bits));
+        continue;
+      }
+
+      Node node;
+      u64 children[4];
+      if (sscanf(line.c_str(), "%d %llu %llu %llu %llu", &node.level,
+            (unsigned long long*)&children[0], (unsigned long long*)&children[1],
+            (unsigned long long*)&children[2], (unsigned long long*)&children[3]) != 5
+          || node.level <= LeafLevel)
+        return fail(path, line);
+      u32 resolved[4];
+      for (int i = 0; i < 4; ++i)
+      {
+        if (children[i] > m_lines.size())
+          return fail(path, line);
+        resolved[i] = children[i] ? m_lines[children[i] - 1] : 0;
+        if (resolved[i] && m_nodes[resolved[i]].level != node.level - 1)
+          return fail(path, line);
+      }
+      m_lines.push_back(make(node.level, resolved[0], resolved[1], resolved[2], resolved[3]));
+    }
+
+    if (m_lines.empty())
+    {
+      std::println(stderr, "Macrocell: {} has no nodes", path);
+      return false;
+    }
+    m_root = m_lines.back();
+    m_level = m_root ? m_nodes[m_root].level : LeafLevel;
+    m_lines.clear();
+    m_lines.shrink_to_fit();
+    return true;
+  }
+
+  bool save(char const* path) const
+  {
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+      std::println(stderr, "Macrocell: could not open {}", path);
+      return false;
+    }
+    fprintf(file, "[M2] (GameOfLifeSimulator)\n#R B3/S23\n");
+
+    // nodes are created children first, so writing them in index order keeps
+    // every reference pointing backwards. Only nodes reachable from the root
+    // are written and renumbered to consecutive line numbers.
+    std::vector<u32> line_of(m_nodes.size(), 0);
+    std::vector<bool> used(m_nodes.size(), false);
+    markUsed(m_root, used);
+    u32 line = 0;
+    std::string row;
+    for (u32 i = 1; i < m_nodes.size(); ++i)
+    {
+      if (!used[i])
+        continue;
+      Node const& node = m_nodes[i];
+      line_of[i] = ++line;
+      if (node.level == LeafLevel)
+      {
+        row.clear();
+        for (i32 y = 0; y < 8; ++y)
+        {
+          u8 bits = (node.bits >> (y * 8)) & 0xff;
+          for (i32 x = 0; bits; ++x, bits >>= 1)
+            row += bits & 1 ? '*' : '.';
+          row += '$';
+        }
+        while (row.size() > 1 && row[row.size() - 1] == '$' && row[row.size() - 2] == '$')
+          row.pop_back();
+        fprintf(file, "%s\n", row.c_str());
+      }
+      else
+      {
+        fprintf(file, "%d %u %u %u %u\n", node.level,
+            line_of[node.nw], line_of[node.ne], line_of[node.sw], line_of[node.se]);
+      }
+    }
+    if (line == 0)
+    {
+      // an empty universe still needs one node for the root
+      fprintf(file, "$\n");
+    }
+    return fclose(file) == 0;
+  }
+
+  // builds the tree straight from a dense row major grid of 0/1 cells
+  static Macrocell fromGrid(i8 const* cells, i32 width, i32 height)
+  {
+    Macrocell result;
+    i32 level = LeafLevel;
+    while ((i64(1) << (level - 1)) < std::max((width + 1) / 2, (height + 1) / 2))
+      ++level;
+    i64 const half = i64(1) << (level - 1);
+    result.m_level = level;
+    result.m_root = result.build(cells, width, height, level, -half + width / 2, -half + height / 2);
+    return result;
+  }
+
+  // writes the part of the universe that overlaps the grid, the rest is dropped
+  void rasterize(i8* cells, i32 width, i32 height)
+  {
+    std::fill(cells, cells + usz(width) * height, 0);
+    u32 node = m_root;
+    i32 level = m_level;
+    // far bigger than the grid, only the area around the center can overlap
+    while (node && level > MaxWalkLevel)
+    {
+      node = centered(node);
+      --level;
+    }
+    if (!node)
+      return;
+    i64 const half = i64(1) << (level - 1);
+    draw(node, level, -half + width / 2, -half + height / 2, cells, width, height);
+  }
+
+private:
+  struct Key
+  {
+    i32 level;
+    u32 nw, ne, sw, se;
+    bool operator==(Key const&) const = default;
+  };
+
+  struct KeyHash
+  {
+    usz operator()(Key const& k) const
+    {
+      u64 h = k.level;
+      for (u32 v : {k.nw, k.ne, k.sw, k.se})
+        h = h * 0x9e3779b97f4a7c15ull + v;
+      return h ^ (h >> 29);
+    }
+  };
+
+  u32 leaf(u64 bits)
+  {
+    if (!bits)
+      return 0;
+    auto [it, inserted] = m_leaves.try_emplace(bits, u32(m_nodes.size()));
+    if (inserted)
+      m_nodes.push_back({.level = LeafLevel, .bits = bits});
+    return it->second;
+  }
+
+  u32 make(i32 level, u32 nw, u32 ne, u32 sw, u32 se)
+  {
+    if (!(nw | ne | sw | se))
+      return 0;
+    auto [it, inserted] = m_branches.try_emplace(Key{level, nw, ne, sw, se}, u32(m_nodes.size()));
+    if (inserted)
+      m_nodes.push_back({.level = level, .nw = nw, .ne = ne, .sw = sw, .se = se});
+    return it->second;
+  }
+
+  // the node one level down that shares the center of node
+  u32 centered(u32 index)
+  {
+    Node const node = m_nodes[index];
+    return make(node.level - 1,
+        m_nodes[node.nw].se, m_nodes[node.ne].sw,
+        m_nodes[node.sw].ne, m_nodes[node.se].nw);
+  }
+
+  u32 build(i8 const* cells, i32 width, i32 height, i32 level, i64 x, i64 y)
+  {
+    i64 const size = i64(1) << level;
+    if (x >= width || y >= height || x + size <= 0 || y + size <= 0)
+      return 0;
+    if (level == LeafLevel)
+    {
+      u64 bits = 0;
+      for (i64 dy = 0; dy < 8; ++dy)
+        for (i64 dx = 0; dx < 8; ++dx)
+        {
+          i64 cx = x + dx, cy = y + dy;
+          if (cx >= 0 && cy >= 0 && cx < width && cy < height && cells[cx + cy * width] == 1)
+            bits |= u64(1) << (dx + dy * 8);
+        }
+      return leaf(bits);
+    }
+    i64 const half = size / 2;
+    u32 nw = build(cells, width, height, level - 1, x, y);
+    u32 ne = build(cells, width, height, level - 1, x + half, y);
+    u32 sw = build(cells, width, height, level - 1, x, y + half);
+    u32 se = build(cells, width, height, level - 1, x + half, y + half);
+    return make(level, nw, ne, sw, se);
+  }
+
+  void draw(u32 index, i32 level, i64 x, i64 y, i8* cells, i32 width, i32 height) const
+  {
+    i64 const size = i64(1) << level;
+    if (!index || x >= width || y >= height || x + size <= 0 || y + size <= 0)
+      return;
+    Node const& node = m_nodes[index];
+    if (level == LeafLevel)
+    {
+      for (u64 bits = node.bits; bits; bits &= bits - 1)
+      {
+        i32 bit = __builtin_ctzll(bits);
+        i64 cx = x + bit % 8, cy = y + bit / 8;
+        if (cx >= 0 && cy >= 0 && cx < width && cy < height)
+          cells[cx + cy * width] = 1;
+      }
+      return;
+    }
+    i64 const half = size / 2;
+    draw(node.nw, level - 1, x, y, cells, width, height);
+    draw(node.ne, level - 1, x + half, y, cells, width, height);
+    draw(node.sw, level - 1, x, y + half, cells, width, height);
+    draw(node.se, level - 1, x + half, y + half, cells, width, height);
+  }
+
+  void markUsed(u32 index, std::vector<bool>& used) const
+  {
+    if (!index || used[index])
+      return;
+    used[index] = true;
+    Node const& node = m_nodes[index];
+    if (node.level == LeafLevel)
+      return;
+    for (u32 child : {node.nw, node.ne, node.sw, node.se})
+      markUsed(child, used);
+  }
+
+  bool fail(char const* path, std::string const& line)
+  {
+    std::println(stderr, "Macrocell: {} has a bad node #{}: '{}'", path, m_lines.size() + 1, line);
+    *this = Macrocell();
+    return false;
+  }
+
+  std::vector<Node> m_nodes;
+  std::unordered_map<u64, u32> m_leaves;
+  std::unordered_map<Key, u32, KeyHash> m_branches;
+  // node index of each line of the file being loaded
+  std::vector<u32> m_lines;
+  u32 m_root = 0;
+  i32 m_level = LeafLevel;
+};
+
+#endif // MACROCELL_HPP_
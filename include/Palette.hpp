@@ -0,0 +1,100 @@
+//
+// Palette.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef PALETTE_HPP_
+#define PALETTE_HPP_
+
+#include <MyTypes.hpp>
+#include <array>
+
+// CPU side copy of the colors used by shaders/default_frag.*
+// keep both in sync, the index is the cell age written by the fade pass
+namespace palette
+{
+
+static constexpr usz Count = 22;
+
+static constexpr f32 Colors[Count][4] = {
+  {0.0, 0.100,  0.800, 1},
+  {0.0, 0.095,  0.760, 1},
+  {0.0, 0.090,  0.720, 1},
+  {0.0, 0.085,  0.680, 1},
+  {0.0, 0.080,  0.640, 1},
+  {0.0, 0.075,  0.600, 1},
+  {0.0, 0.070,  0.560, 1},
+  {0.0, 0.065,  0.520, 1},
+  {0.0, 0.060,  0.480, 1},
+  {0.0, 0.055,  0.440, 1},
+  {0.0, 0.050,  0.400, 1},
+  {0.0, 0.045,  0.360, 1},
+  {0.0, 0.040,  0.320, 1},
+  {0.0, 0.035,  0.280, 1},
+  {0.0, 0.030,  0.240, 1},
+  {0.0, 0.025,  0.200, 1},
+  {0.0, 0.020,  0.160, 1},
+  {0.0, 0.015,  0.120, 1},
+  {0.0, 0.010,  0.080, 1},
+  {0.0, 0.005,  0.040, 1},
+  {0.0, 0.025,  0.2,   1},
+  {1,   1,      1,     1}
+};
+
+// color of the gap drawn between cells when zoomed in
+static constexpr f32 Margin[4] = {0, 0.0125, 0.1, 1};
+// render pass clear color, visible outside of the grid
+static constexpr f32 Clear[4] = {0.f, 0.025f, 0.2f, 1.f};
+
+inline constexpr u8 toByte(f32 const c)
+{
+  return static_cast<u8>(c * 255.f + 0.5f);
+}
+
+inline constexpr std::array<u8, 4> toRGBA8(f32 const (&c)[4])
+{
+  return {toByte(c[0]), toByte(c[1]), toByte(c[2]), toByte(c[3])};
+}
+
+static constexpr std::array<std::array<u8, 4>, Count> RGBA8 = [] {
+  std::array<std::array<u8, 4>, Count> result{};
+  for (usz i = 0; i < Count; ++i)
+    result[i] = toRGBA8(Colors[i]);
+  return result;
+}();
+
+static constexpr std::array<u8, 4> MarginRGBA8 = toRGBA8(Margin);
+static constexpr std::array<u8, 4> ClearRGBA8  = toRGBA8(Clear);
+
+// packed render format: 16 levels so two cells fit in a byte.
+// 14 fade levels, then background and alive keep their exact colors.
+// PackedAge must match packedAge in the fragment shaders.
+static constexpr usz PackedCount = 16;
+
+static constexpr std::array<i8, PackedCount> PackedAge = {
+  0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 18, 19, 20, 21
+};
+
+// nearest packed level of every age
+static constexpr std::array<u8, Count> PackedLevel = [] {
+  std::array<u8, Count> result{};
+  for (usz age = 0; age < Count; ++age)
+  {
+    usz best = 0;
+    for (usz level = 1; level < PackedCount; ++level)
+    {
+      i32 distance = PackedAge[level] - i32(age), best_distance = PackedAge[best] - i32(age);
+      if (distance * distance < best_distance * best_distance)
+        best = level;
+    }
+    result[age] = best;
+  }
+  return result;
+}();
+
+} // namespace palette
+
+#endif // PALETTE_HPP_
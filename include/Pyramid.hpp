@@ -0,0 +1,188 @@
+//
+// Pyramid.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef PYRAMID_HPP_
+#define PYRAMID_HPP_
+
+#include <MyTypes.hpp>
+#include <array>
+#include <vector>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#include "Palette.hpp"
+
+// Mip chain of the grid for zoomed out views, level k averages 2^k x 2^k cells.
+// Every texel is a u16: the low byte is the alive density and the high byte
+// the blue channel of the other cells averaged over the whole block (alive
+// cells count as 0). Every non alive palette color is (0, blue / 8, blue), so
+// the two bytes give the exact mean color and average linearly level to level.
+// Only rows below dirty source rows are reduced again.
+class Pyramid
+{
+public:
+  static constexpr i32 MaxLevel = 4;
+
+  struct Level
+  {
+    i32 width = 0, height = 0;
+    std::vector<u16> texels;
+    // rows changed by the last update()
+    std::vector<u8> dirty_rows;
+  };
+
+  Pyramid(i32 width, i32 height)
+  : m_width{width}
+  {
+    for (i32 k = 1; k <= MaxLevel; ++k)
+    {
+      Level& level = m_levels[k];
+      level.width = width >> k;
+      level.height = height >> k;
+      level.texels.resize(usz(level.width) * level.height);
+      level.dirty_rows.resize(level.height);
+    }
+  }
+
+  // source holds the ages of every cell, or two palette::PackedLevel
+  // nibbles per byte when packed. dirty_rows flags the changed source rows.
+  void update(u8 const* source, bool packed, u8 const* dirty_rows)
+  {
+    bool const all = m_stale;
+    m_stale = false;
+    Level& first = m_levels[1];
+    for (i32 y = 0; y < first.height; ++y)
+    {
+      first.dirty_rows[y] = all || dirty_rows[2 * y] || dirty_rows[2 * y + 1];
+      if (!first.dirty_rows[y])
+        continue;
+      if (packed)
+        reducePackedRow(source, y);
+      else
+        reduceAgeRow(source, y);
+    }
+    for (i32 k = 2; k <= MaxLevel; ++k)
+    {
+      Level const& below = m_levels[k - 1];
+      Level& level = m_levels[k];
+      for (i32 y = 0; y < level.height; ++y)
+      {
+        level.dirty_rows[y] = below.dirty_rows[2 * y] || below.dirty_rows[2 * y + 1];
+        if (level.dirty_rows[y])
+          reduceLevelRow(below, level, y);
+      }
+    }
+  }
+
+  // the next update() rebuilds every level
+  void invalidate() { m_stale = true; }
+  bool stale() const { return m_stale; }
+
+  Level const& level(i32 k) const { return m_levels[k]; }
+
+private:
+  struct Texel { u8 alive, blue; };
+
+  static constexpr std::array<Texel, palette::Count> AgeTexel = [] {
+    std::array<Texel, palette::Count> result{};
+    for (usz age = 0; age < palette::Count; ++age)
+      result[age] = age == 21 ? Texel{255, 0} : Texel{0, palette::toByte(palette::Colors[age][2])};
+    return result;
+  }();
+
+  // sums of the two cells held by a packed byte
+  static constexpr std::array<std::array<u16, 2>, 256> PackedPair = [] {
+    std::array<std::array<u16, 2>, 256> result{};
+    for (usz byte = 0; byte < 256; ++byte)
+    {
+      Texel const even = AgeTexel[palette::PackedAge[byte & 0xf]];
+      Texel const odd = AgeTexel[palette::PackedAge[byte >> 4]];
+      result[byte] = {u16(even.alive + odd.alive), u16(even.blue + odd.blue)};
+    }
+    return result;
+  }();
+
+  static u16 texel(u32 alive_sum, u32 blue_sum)
+  {
+    return u16(((alive_sum + 2) >> 2) | (((blue_sum + 2) >> 2) << 8));
+  }
+
+  void reduceAgeRow(u8 const* ages, i32 y)
+  {
+    Level& level = m_levels[1];
+    u8 const* top = ages + usz(2 * y) * m_width;
+    u8 const* bottom = top + m_width;
+    u16* out = level.texels.data() + usz(y) * level.width;
+    for (i32 x = 0; x < level.width; ++x)
+    {
+      Texel const a = AgeTexel[top[2 * x]], b = AgeTexel[top[2 * x + 1]];
+      Texel const c = AgeTexel[bottom[2 * x]], d = AgeTexel[bottom[2 * x + 1]];
+      out[x] = texel(a.alive + b.alive + c.alive + d.alive, a.blue + b.blue + c.blue + d.blue);
+    }
+  }
+
+  // a packed byte is exactly one horizontal pair of the 2x2 block
+  void reducePackedRow(u8 const* packed, i32 y)
+  {
+    Level& level = m_levels[1];
+    u8 const* top = packed + usz(2 * y) * (m_width / 2);
+    u8 const* bottom = top + m_width / 2;
+    u16* out = level.texels.data() + usz(y) * level.width;
+    for (i32 x = 0; x < level.width; ++x)
+    {
+      auto const& a = PackedPair[top[x]];
+      auto const& b = PackedPair[bottom[x]];
+      out[x] = texel(a[0] + b[0], a[1] + b[1]);
+    }
+  }
+
+  // eight texels of level at a time: the bytes are split into 16 bit lanes,
+  // the rows added, and the horizontal pairs added by one multiply-add
+  static void reduceLevelRow(Level const& below, Level& level, i32 y)
+  {
+    u16 const* top = below.texels.data() + usz(2 * y) * below.width;
+    u16 const* bottom = top + below.width;
+    u16* out = level.texels.data() + usz(y) * level.width;
+    i32 x = 0;
+#if defined(__SSE2__)
+    __m128i const low = _mm_set1_epi16(0xff), one = _mm_set1_epi16(1), two = _mm_set1_epi32(2);
+    // alive and blue sums of four output texels, one per 32 bit lane
+    auto sums = [&](__m128i const t, __m128i const b, __m128i& alive, __m128i& blue) {
+      alive = _mm_madd_epi16(_mm_add_epi16(_mm_and_si128(t, low), _mm_and_si128(b, low)), one);
+      blue = _mm_madd_epi16(_mm_add_epi16(_mm_srli_epi16(t, 8), _mm_srli_epi16(b, 8)), one);
+    };
+    for (; x + 8 <= level.width; x += 8)
+    {
+      auto load = [](u16 const* p) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); };
+      __m128i alive0, blue0, alive1, blue1;
+      sums(load(top + 2 * x), load(bottom + 2 * x), alive0, blue0);
+      sums(load(top + 2 * x + 8), load(bottom + 2 * x + 8), alive1, blue1);
+      // at most 1020 + 2, the packs never saturate
+      __m128i const alive = _mm_packs_epi32(_mm_srli_epi32(_mm_add_epi32(alive0, two), 2),
+                                            _mm_srli_epi32(_mm_add_epi32(alive1, two), 2));
+      __m128i const blue = _mm_packs_epi32(_mm_srli_epi32(_mm_add_epi32(blue0, two), 2),
+                                           _mm_srli_epi32(_mm_add_epi32(blue1, two), 2));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_or_si128(alive, _mm_slli_epi16(blue, 8)));
+    }
+#endif
+    for (; x < level.width; ++x)
+    {
+      u32 const a = top[2 * x], b = top[2 * x + 1], c = bottom[2 * x], d = bottom[2 * x + 1];
+      out[x] = texel((a & 0xff) + (b & 0xff) + (c & 0xff) + (d & 0xff),
+                     (a >> 8) + (b >> 8) + (c >> 8) + (d >> 8));
+    }
+  }
+
+  i32 m_width;
+  Level m_levels[MaxLevel + 1];
+  bool m_stale = true;
+};
+
+#endif // PYRAMID_HPP_
@@ -0,0 +1,231 @@
+//
+// SharedGrid.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef SHAREDGRID_HPP_
+#define SHAREDGRID_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <new>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+# define SHARED_GRID_SUPPORTED 1
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#else
+# define SHARED_GRID_SUPPORTED 0
+#endif
+
+// POSIX shared memory segment that holds the simulation buffers themselves:
+// both cell buffers and the age buffer live inside it, so publishing a
+// generation costs two stores and readers never copy anything.
+//
+// Reading protocol (seqlock):
+//   s1 = sequence (retry while odd)
+//   use cells[current] / ages
+//   s2 = sequence, the data was consistent if s1 == s2
+// The sequence is odd while a generation is being computed or cells are
+// being edited. cells[current] itself is only rewritten two generations
+// later, so a reader that only needs cells can skip the second check as
+// long as it keeps up.
+namespace shared_grid
+{
+
+static constexpr char Magic[8] = {'G', 'O', 'L', 'S', 'H', 'M', '0', '1'};
+
+struct Header
+{
+  char magic[8];
+  u32 width, height;
+  u64 cells_offset[2];
+  u64 ages_offset;
+  std::atomic<u64> sequence;
+  std::atomic<u64> generation;
+  std::atomic<u32> current;
+};
+
+static_assert(std::atomic<u64>::is_always_lock_free);
+
+inline constexpr u64 alignUp(u64 value)
+{
+  return (value + 63) & ~u64(63);
+}
+
+} // namespace shared_grid
+
+class SharedGrid
+{
+public:
+  SharedGrid() = default;
+  SharedGrid(const SharedGrid&) = delete;
+  SharedGrid& operator=(const SharedGrid&) = delete;
+
+  ~SharedGrid()
+  {
+#if SHARED_GRID_SUPPORTED
+    if (m_header)
+    {
+      munmap(m_header, m_size);
+      shm_unlink(m_name.c_str());
+    }
+#endif
+  }
+
+  // name follows shm_open rules, e.g. "/gol"
+  bool create(char const* name, i32 width, i32 height)
+  {
+#if SHARED_GRID_SUPPORTED
+    using namespace shared_grid;
+    u64 const count = u64(width) * height;
+    u64 const cells0 = alignUp(sizeof(Header));
+    u64 const cells1 = alignUp(cells0 + count);
+    u64 const ages = alignUp(cells1 + count);
+    m_size = ages + count;
+
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, m_size) != 0)
+    {
+      std::println(stderr, "SharedGrid: could not create {}: {}", name, strerror(errno));
+      if (fd >= 0)
+      {
+        close(fd);
+        shm_unlink(name);
+      }
+      return false;
+    }
+    void* memory = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+      std::println(stderr, "SharedGrid: could not map {}: {}", name, strerror(errno));
+      shm_unlink(name);
+      return false;
+    }
+
+    m_name = name;
+    m_header = new (memory) Header{
+      .width = u32(width), .height = u32(height),
+      .cells_offset = {cells0, cells1}, .ages_offset = ages,
+    };
+    // written last, readers check it before trusting the rest
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(m_header->magic, Magic, sizeof(Magic));
+    return true;
+#else
+    std::println(stderr, "SharedGrid: shared memory export is not supported on this platform");
+    return false;
+#endif
+  }
+
+  i8* cells(u32 index) { return base() + m_header->cells_offset[index]; }
+  i8* ages() { return base() + m_header->ages_offset; }
+
+  // brackets every change of the published buffers
+  void beginWrite()
+  {
+    m_header->sequence.fetch_add(1, std::memory_order_acq_rel);
+  }
+
+  void endWrite(u64 generation, u32 current)
+  {
+    m_header->generation.store(generation, std::memory_order_relaxed);
+    m_header->current.store(current, std::memory_order_relaxed);
+    m_header->sequence.fetch_add(1, std::memory_order_release);
+  }
+
+private:
+  i8* base() { return reinterpret_cast<i8*>(m_header); }
+
+  shared_grid::Header* m_header = nullptr;
+  u64 m_size = 0;
+  std::string m_name;
+};
+
+// read only view for consumers in other processes
+class SharedGridReader
+{
+public:
+  SharedGridReader() = default;
+  SharedGridReader(const SharedGridReader&) = delete;
+  SharedGridReader& operator=(const SharedGridReader&) = delete;
+
+  ~SharedGridReader()
+  {
+#if SHARED_GRID_SUPPORTED
+    if (m_header)
+      munmap(const_cast<shared_grid::Header*>(m_header), m_size);
+#endif
+  }
+
+  bool open(char const* name)
+  {
+#if SHARED_GRID_SUPPORTED
+    int fd = shm_open(name, O_RDONLY, 0);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || u64(info.st_size) < sizeof(shared_grid::Header))
+    {
+      if (fd >= 0)
+        close(fd);
+      return false;
+    }
+    m_size = info.st_size;
+    void* memory = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+      return false;
+    m_header = static_cast<shared_grid::Header const*>(memory);
+    if (memcmp(m_header->magic, shared_grid::Magic, sizeof(shared_grid::Magic)) != 0)
+    {
+      munmap(memory, m_size);
+      m_header = nullptr;
+      return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  shared_grid::Header const& header() const { return *m_header; }
+  i32 width()  const { return m_header->width; }
+  i32 height() const { return m_header->height; }
+
+  // waits for an even sequence, returns it to be passed to validate()
+  u64 begin() const
+  {
+    u64 sequence;
+    while ((sequence = m_header->sequence.load(std::memory_order_acquire)) & 1)
+      std::this_thread::yield();
+    return sequence;
+  }
+
+  bool validate(u64 sequence) const
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_header->sequence.load(std::memory_order_relaxed) == sequence;
+  }
+
+  u64 generation() const { return m_header->generation.load(std::memory_order_relaxed); }
+  i8 const* cells() const { return base() + m_header->cells_offset[m_header->current.load(std::memory_order_relaxed)]; }
+  i8 const* ages() const { return base() + m_header->ages_offset; }
+
+private:
+  i8 const* base() const { return reinterpret_cast<i8 const*>(m_header); }
+
+  shared_grid::Header const* m_header = nullptr;
+  u64 m_size = 0;
+};
+
+#endif // SHAREDGRID_HPP_
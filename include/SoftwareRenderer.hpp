@@ -0,0 +1,299 @@
+//
+// SoftwareRenderer.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef SOFTWARERENDERER_HPP_
+#define SOFTWARERENDERER_HPP_
+
+#include <MyTypes.hpp>
+#include <print>
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#include "Palette.hpp"
+#include "Trace.hpp"
+
+namespace software_renderer
+{
+
+// RGBA8 bytes as one little endian word
+inline constexpr u32 pack(std::array<u8, 4> const& c)
+{
+  return u32(c[0]) | (u32(c[1]) << 8) | (u32(c[2]) << 16) | (u32(c[3]) << 24);
+}
+
+// count pixels of one color, four per store
+inline void splat(u32* out, i32 count, u32 color)
+{
+  i32 x = 0;
+#if defined(__SSE2__)
+  __m128i const colors = _mm_set1_epi32(i32(color));
+  for (; x + 4 <= count; x += 4)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), colors);
+#endif
+  for (; x < count; ++x)
+    out[x] = color;
+}
+
+} // namespace software_renderer
+
+// CPU version of FSmain for hosts without a GPU device and for CI.
+// Every pixel samples the grid at its center exactly like the fragment
+// shader: clear color outside the grid, margin color in the outer 10% of a
+// cell, otherwise the palette color of the cell age. Rows are split in
+// bands over a pool of threads that lives as long as the renderer.
+class SoftwareRenderer
+{
+public:
+  // cell coordinate of the top left corner of pixel (0, 0) and cells per pixel
+  struct View
+  {
+    f32 x = 0, y = 0;
+    f32 cells_per_pixel = 1;
+  };
+
+  explicit SoftwareRenderer(usz threads = std::thread::hardware_concurrency())
+  {
+    // the calling thread renders too
+    for (usz i = 1; i < std::max<usz>(threads, 1); ++i)
+      m_workers.emplace_back([this] { workerLoop(); });
+  }
+
+  SoftwareRenderer(const SoftwareRenderer&) = delete;
+  SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+  ~SoftwareRenderer()
+  {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+      worker.join();
+  }
+
+  // cells holds one age per cell, or two palette::PackedLevel nibbles per
+  // byte when packed. rgba receives width * height RGBA8 pixels, top row first.
+  void render(u8 const* cells, bool packed, i32 grid_width, i32 grid_height,
+              View const& view, u8* rgba, i32 width, i32 height)
+  {
+    // the horizontal mapping is the same for every row
+    m_columns.resize(width);
+    f32 const step = view.cells_per_pixel;
+    i32 const x0 = std::clamp<i32>(std::ceil(-view.x / step - 0.5f), 0, width);
+    i32 const x1 = std::clamp<i32>(std::ceil((grid_width - view.x) / step - 0.5f), x0, width);
+    for (i32 x = x0; x < x1; ++x)
+    {
+      f32 const cx = view.x + (x + 0.5f) * step;
+      f32 const local_x = cx - std::floor(cx);
+      // rounding at the grid edges must not step outside the row
+      m_columns[x] = local_x < Margin || local_x > 1 - Margin
+                   ? -1 : std::min<i32>(i32(std::max(cx, 0.f)), grid_width - 1);
+    }
+    // zoomed in, neighbouring pixels share a column and every row is a
+    // few wide runs of one color each
+    m_runs.clear();
+    for (i32 x = x0; x < x1; ++x)
+      if (m_runs.empty() || m_columns[x] != m_columns[m_runs.back().x])
+        m_runs.push_back({x, m_columns[x]});
+    bool const runs = m_runs.size() * MinRun <= usz(x1 - x0);
+    m_runs.push_back({x1, -1});
+    {
+      std::lock_guard lock(m_mutex);
+      m_job = {cells, packed, grid_width, grid_height, view, reinterpret_cast<u32*>(rgba), width, height,
+               m_columns.data(), x0, x1, runs ? m_runs.data() : nullptr};
+      m_nextRow.store(0, std::memory_order_relaxed);
+      m_pending = m_workers.size();
+      m_frame++;
+    }
+    m_wake.notify_all();
+    renderRows(m_job);
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+  }
+
+  static bool writePPM(char const* path, u8 const* rgba, i32 width, i32 height)
+  {
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+      std::println(stderr, "SoftwareRenderer: could not open {}", path);
+      return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<u8> row(usz(width) * 3);
+    bool ok = true;
+    for (i32 y = 0; y < height && ok; ++y)
+    {
+      u8 const* in = rgba + usz(y) * width * 4;
+      for (i32 x = 0; x < width; ++x)
+        memcpy(&row[x * 3], in + x * 4, 3);
+      ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+      std::println(stderr, "SoftwareRenderer: could not write {}", path);
+    return ok;
+  }
+
+private:
+  // the pixels from x up to the next run show one cell column, -1 the margin
+  struct Run
+  {
+    i32 x, column;
+  };
+
+  struct Job
+  {
+    u8 const* cells;
+    bool packed;
+    i32 grid_width, grid_height;
+    View view;
+    u32* out;
+    i32 width, height;
+    // cell column of every pixel, -1 inside the margin
+    i32 const* columns;
+    i32 x0, x1;
+    // runs of pixels on one column ending with one at x1, null when they are too short
+    Run const* runs;
+  };
+
+  static constexpr i32 BandRows = 16;
+  // average run width from which the rows are splatted run by run
+  static constexpr usz MinRun = 4;
+  static constexpr f32 Margin = 0.1f;
+
+  static constexpr u32 ClearColor = software_renderer::pack(palette::ClearRGBA8);
+  static constexpr u32 MarginColor = software_renderer::pack(palette::MarginRGBA8);
+
+  // indexed by age, or by nibble for packed cells
+  static constexpr std::array<u32, palette::Count> AgeColor = [] {
+    std::array<u32, palette::Count> result{};
+    for (usz age = 0; age < palette::Count; ++age)
+      result[age] = software_renderer::pack(palette::RGBA8[age]);
+    return result;
+  }();
+  static constexpr std::array<u32, palette::PackedCount> LevelColor = [] {
+    std::array<u32, palette::PackedCount> result{};
+    for (usz level = 0; level < palette::PackedCount; ++level)
+      result[level] = software_renderer::pack(palette::RGBA8[palette::PackedAge[level]]);
+    return result;
+  }();
+
+  void workerLoop()
+  {
+    TRACE_THREAD("software renderer");
+    u64 seen = 0;
+    for (;;)
+    {
+      {
+        std::unique_lock lock(m_mutex);
+        m_wake.wait(lock, [&] { return m_stopping || m_frame != seen; });
+        if (m_stopping)
+          return;
+        seen = m_frame;
+      }
+      renderRows(m_job);
+      {
+        std::lock_guard lock(m_mutex);
+        --m_pending;
+      }
+      m_done.notify_one();
+    }
+  }
+
+  void renderRows(Job const& job)
+  {
+    for (;;)
+    {
+      i32 const first = m_nextRow.fetch_add(BandRows, std::memory_order_relaxed);
+      if (first >= job.height)
+        return;
+      TRACE_SCOPE("band");
+      for (i32 y = first; y < std::min(first + BandRows, job.height); ++y)
+        renderRow(job, y);
+    }
+  }
+
+  static void renderRow(Job const& job, i32 y)
+  {
+    u32* out = job.out + usz(y) * job.width;
+    f32 const step = job.view.cells_per_pixel;
+    f32 const cy = job.view.y + (y + 0.5f) * step;
+    if (cy < 0 || cy >= job.grid_height)
+    {
+      std::fill(out, out + job.width, ClearColor);
+      return;
+    }
+    f32 const local_y = cy - std::floor(cy);
+    bool const margin_row = local_y < Margin || local_y > 1 - Margin;
+    usz const row = usz(cy) * job.grid_width;
+
+    // pixels left and right of the grid, the loop below only sees cells
+    i32 const x0 = job.x0, x1 = job.x1;
+    std::fill(out, out + x0, ClearColor);
+    std::fill(out + x1, out + job.width, ClearColor);
+    if (margin_row)
+    {
+      software_renderer::splat(out + x0, x1 - x0, MarginColor);
+      return;
+    }
+
+    u8 const* cells = job.cells;
+    if (job.runs)
+    {
+      for (Run const* run = job.runs; run->x < x1; ++run)
+      {
+        u32 color = MarginColor;
+        if (run->column >= 0)
+        {
+          usz const i = row + run->column;
+          color = job.packed ? LevelColor[(cells[i / 2] >> ((i & 1) * 4)) & 0xf] : AgeColor[cells[i]];
+        }
+        software_renderer::splat(out + run->x, run[1].x - run->x, color);
+      }
+      return;
+    }
+    i32 const* columns = job.columns;
+    if (job.packed)
+      for (i32 x = x0; x < x1; ++x)
+      {
+        usz const i = row + columns[x];
+        out[x] = columns[x] < 0 ? MarginColor : LevelColor[(cells[i / 2] >> ((i & 1) * 4)) & 0xf];
+      }
+    else
+      for (i32 x = x0; x < x1; ++x)
+        out[x] = columns[x] < 0 ? MarginColor : AgeColor[cells[row + columns[x]]];
+  }
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  Job m_job{};
+  std::vector<i32> m_columns;
+  std::vector<Run> m_runs;
+  std::atomic<i32> m_nextRow = 0;
+  usz m_pending = 0;
+  u64 m_frame = 0;
+  bool m_stopping = false;
+};
+
+#endif // SOFTWARERENDERER_HPP_
@@ -0,0 +1,207 @@
+//
+// Stepper.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef STEPPER_HPP_
+#define STEPPER_HPP_
+
+#include <MyTypes.hpp>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+#include "Life.hpp"
+#include "Trace.hpp"
+
+// life::step and life::stepCells over a pool of threads that lives as long
+// as the stepper. Rows are handed out in bands of band_rows through one
+// atomic, like the bands of the SoftwareRenderer. Two kernels:
+//   Passes  counts every band, waits for all of them, then applies the rule
+//           to every band. With one thread this is life::step itself.
+//   Fused   counts and applies the rule band by band while the band is still
+//           in cache. Bands only read current, so they never wait for
+//           each other.
+// Every configuration gives the same generation, only the speed differs.
+class Stepper
+{
+public:
+  enum class Kernel { Passes, Fused };
+
+  struct Config
+  {
+    Kernel kernel = Kernel::Passes;
+    // the calling thread steps too, 1 starts no pool
+    usz threads = 1;
+    i32 band_rows = 64;
+  };
+
+  static char const* name(Kernel kernel)
+  {
+    return kernel == Kernel::Fused ? "fused" : "passes";
+  }
+
+  explicit Stepper(Config const& config)
+  : m_config{config}
+  {
+    m_config.threads = std::max<usz>(m_config.threads, 1);
+    m_config.band_rows = std::max(m_config.band_rows, 1);
+    for (usz i = 1; i < m_config.threads; ++i)
+      m_workers.emplace_back([this] { workerLoop(); });
+  }
+
+  Stepper(const Stepper&) = delete;
+  Stepper& operator=(const Stepper&) = delete;
+
+  ~Stepper()
+  {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+      worker.join();
+  }
+
+  Config const& config() const { return m_config; }
+
+  void step(i8 const* current_cells, i8* next_cells, i32 gridWidth, i32 gridHeight, life::Output const& output)
+  {
+    if (sequential())
+      life::step(current_cells, next_cells, gridWidth, gridHeight, output);
+    else
+      run({current_cells, next_cells, gridWidth, gridHeight, output, false});
+  }
+
+  void stepCells(i8 const* current_cells, i8* next_cells, i32 gridWidth, i32 gridHeight,
+                 life::Counts* counts = nullptr)
+  {
+    if (sequential())
+      life::stepCells(current_cells, next_cells, gridWidth, gridHeight, counts);
+    else
+      run({current_cells, next_cells, gridWidth, gridHeight, {.ages = nullptr, .counts = counts}, true});
+  }
+
+private:
+  enum class Pass { Count, Rule, Both };
+
+  struct Job
+  {
+    i8 const* current;
+    i8* next;
+    i32 width, height;
+    life::Output output;
+    // the rule alone, output only carries the counts
+    bool cells;
+  };
+
+  bool sequential() const { return m_workers.empty() && m_config.kernel == Kernel::Passes; }
+
+  void run(Job const& job)
+  {
+    m_counts = {};
+    if (m_config.kernel == Kernel::Passes)
+    {
+      dispatch(job, Pass::Count);
+      dispatch(job, Pass::Rule);
+    }
+    else
+      dispatch(job, Pass::Both);
+    if (job.output.counts)
+      *job.output.counts = m_counts;
+  }
+
+  void dispatch(Job const& job, Pass pass)
+  {
+    {
+      std::lock_guard lock(m_mutex);
+      m_job = job;
+      m_pass = pass;
+      m_nextRow.store(0, std::memory_order_relaxed);
+      m_pending = m_workers.size();
+      m_round++;
+    }
+    m_wake.notify_all();
+    stepBands();
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+  }
+
+  void workerLoop()
+  {
+    TRACE_THREAD("stepper");
+    u64 seen = 0;
+    for (;;)
+    {
+      {
+        std::unique_lock lock(m_mutex);
+        m_wake.wait(lock, [&] { return m_stopping || m_round != seen; });
+        if (m_stopping)
+          return;
+        seen = m_round;
+      }
+      stepBands();
+      {
+        std::lock_guard lock(m_mutex);
+        --m_pending;
+      }
+      m_done.notify_one();
+    }
+  }
+
+  void stepBands()
+  {
+    Job const& job = m_job;
+    Pass const pass = m_pass;
+    i32 const band_rows = m_config.band_rows;
+    life::Counts counts;
+    for (;;)
+    {
+      i32 const first = m_nextRow.fetch_add(band_rows, std::memory_order_relaxed);
+      if (first >= job.height)
+        break;
+      TRACE_SCOPE("step band");
+      i32 const last = std::min(first + band_rows, job.height);
+      if (pass != Pass::Rule)
+        life::countNeighboursRows(job.current, job.next, job.width, job.height, first, last);
+      if (pass == Pass::Count)
+        continue;
+      if (job.cells)
+        life::applyRuleCellsRows(job.current, job.next, job.width, first, last,
+                                 job.output.counts ? &counts : nullptr);
+      else
+        life::applyRuleRows(job.current, job.next, job.width, first, last, job.output, counts);
+    }
+    if (pass == Pass::Count)
+      return;
+    // every thread fences its own streaming stores
+    if (!job.cells)
+      life::fenceRender(job.output);
+    std::lock_guard lock(m_mutex);
+    m_counts.population += counts.population;
+    m_counts.births += counts.births;
+    m_counts.deaths += counts.deaths;
+  }
+
+  Config m_config;
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  Job m_job{};
+  Pass m_pass = Pass::Both;
+  life::Counts m_counts;
+  std::atomic<i32> m_nextRow = 0;
+  usz m_pending = 0;
+  u64 m_round = 0;
+  bool m_stopping = false;
+};
+
+#endif // STEPPER_HPP_
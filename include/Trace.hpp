@@ -0,0 +1,195 @@
+//
+// Trace.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <MyTypes.hpp>
+
+// Scoped timeline events written as Chrome trace JSON (chrome://tracing,
+// ui.perfetto.dev). Only built with GOL_TRACE defined, otherwise every macro
+// expands to nothing and none of this is compiled:
+//   TRACE_SCOPE("name");        // event from here to the end of the scope
+//   TRACE_THREAD("name");       // names the calling thread in the trace
+// Every thread records into its own ring of the last RingEvents events with
+// plain stores and one release store of its head, so recording never takes
+// a lock. Names must be string literals, only the pointer is stored.
+
+#if defined(GOL_TRACE)
+
+#include <print>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+#include <Clock.hpp>
+
+namespace trace
+{
+
+inline constexpr bool Enabled = true;
+
+class Ring
+{
+public:
+  static constexpr usz RingEvents = usz(1) << 16;
+
+  struct Event
+  {
+    char const* name;
+    u64 begin_ns, end_ns;
+  };
+
+  explicit Ring(u32 id) : m_id{id} {}
+
+  void record(char const* name, u64 begin_ns, u64 end_ns)
+  {
+    u64 const head = m_head.load(std::memory_order_relaxed);
+    m_events[head % RingEvents] = {name, begin_ns, end_ns};
+    m_head.store(head + 1, std::memory_order_release);
+  }
+
+  // the recorded events oldest first, events the owner overwrote while
+  // they were being copied are left out. The owner may also be halfway
+  // through writing event after, into the slot of event after - RingEvents.
+  std::vector<Event> snapshot() const
+  {
+    u64 const head = m_head.load(std::memory_order_acquire);
+    u64 const first = head > RingEvents ? head - RingEvents : 0;
+    std::vector<Event> events;
+    events.reserve(head - first);
+    for (u64 i = first; i < head; ++i)
+      events.push_back(m_events[i % RingEvents]);
+    u64 const after = m_head.load(std::memory_order_acquire) + 1;
+    usz const overwritten = after > first + RingEvents ? after - first - RingEvents : 0;
+    events.erase(events.begin(), events.begin() + std::min(overwritten, events.size()));
+    return events;
+  }
+
+  u32 id() const { return m_id; }
+  char const* name = nullptr;
+
+private:
+  u32 m_id;
+  std::atomic<u64> m_head = 0;
+  Event m_events[RingEvents];
+};
+
+// rings outlive their threads so a dump at exit still sees workers that ended
+class Registry
+{
+public:
+  static Registry& get()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  Ring& ring()
+  {
+    thread_local Ring* ring = nullptr;
+    if (!ring)
+    {
+      std::lock_guard lock(m_mutex);
+      m_rings.push_back(std::make_unique<Ring>(u32(m_rings.size()) + 1));
+      ring = m_rings.back().get();
+    }
+    return *ring;
+  }
+
+  bool dump(char const* path)
+  {
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+      std::println(stderr, "Trace: could not open {}", path);
+      return false;
+    }
+    std::lock_guard lock(m_mutex);
+    usz count = 0;
+    std::println(file, "{{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    char const* separator = "";
+    for (std::unique_ptr<Ring> const& ring : m_rings)
+    {
+      if (ring->name)
+      {
+        std::print(file, "{}{{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": {}, "
+                         "\"args\": {{\"name\": \"{}\"}}}}", separator, ring->id(), ring->name);
+        separator = ",\n";
+      }
+      for (Ring::Event const& event : ring->snapshot())
+      {
+        std::print(file, "{}{{\"ph\": \"X\", \"name\": \"{}\", \"pid\": 1, \"tid\": {}, "
+                         "\"ts\": {:.3f}, \"dur\": {:.3f}}}", separator, event.name, ring->id(),
+                   event.begin_ns * 1.e-3, (event.end_ns - event.begin_ns) * 1.e-3);
+        separator = ",\n";
+        count++;
+      }
+    }
+    std::println(file, "\n]}}");
+    bool const ok = fclose(file) == 0;
+    if (ok)
+      std::println("trace {}: {} events", path, count);
+    else
+      std::println(stderr, "Trace: could not write {}", path);
+    return ok;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<Ring>> m_rings;
+};
+
+// TSC based, a band of the software renderer is only a few microseconds
+inline u64 now()
+{
+  return math::TscClock::Now().asNanoseconds();
+}
+
+class Scope
+{
+public:
+  explicit Scope(char const* name) : m_name{name}, m_begin{now()} {}
+  ~Scope() { Registry::get().ring().record(m_name, m_begin, now()); }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  char const* m_name;
+  u64 m_begin;
+};
+
+inline bool dump(char const* path) { return Registry::get().dump(path); }
+
+} // namespace trace
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_THREAD(thread_name) (trace::Registry::get().ring().name = (thread_name))
+
+#else
+
+namespace trace
+{
+
+inline constexpr bool Enabled = false;
+inline bool dump(char const*) { return false; }
+
+} // namespace trace
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD(thread_name) ((void)0)
+
+#endif // GOL_TRACE
+
+#endif // TRACE_HPP_
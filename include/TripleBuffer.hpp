@@ -0,0 +1,94 @@
+//
+// TripleBuffer.hpp
+// GOLRenderer
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#ifndef TRIPLEBUFFER_HPP_
+#define TRIPLEBUFFER_HPP_
+
+#include <MyTypes.hpp>
+#include <vector>
+#include <mutex>
+#include <utility>
+
+// Hands whole frames from one producer thread to one consumer thread.
+// The producer always owns a slot to fill and the consumer always owns the
+// slot it is reading, neither ever waits for the other beyond the swap.
+// Frames the consumer never picked up are dropped, but their dirty rows
+// are carried into the next frame so partial uploads stay correct.
+class TripleBuffer
+{
+public:
+  struct Frame
+  {
+    std::vector<u8> data;
+    // 1 for every row that changed since the previous published frame
+    std::vector<u8> dirty_rows;
+    u64 generation = 0;
+  };
+
+  TripleBuffer(usz row_bytes, usz rows)
+  {
+    for (Frame& frame : m_slots)
+    {
+      frame.data.resize(row_bytes * rows);
+      frame.dirty_rows.resize(rows, 1);
+    }
+  }
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // producer side, fill every byte of data and dirty_rows then publish()
+  Frame& back() { return m_slots[m_back]; }
+
+  void publish()
+  {
+    std::lock_guard lock(m_mutex);
+    Frame& back = m_slots[m_back];
+    if (m_fresh)
+    {
+      Frame const& skipped = m_slots[m_ready];
+      for (usz y = 0; y < back.dirty_rows.size(); ++y)
+        back.dirty_rows[y] |= skipped.dirty_rows[y];
+      m_dropped++;
+    }
+    std::swap(m_back, m_ready);
+    m_fresh = true;
+    m_published++;
+  }
+
+  // consumer side, the newest frame or nullptr when nothing new was published
+  Frame* acquire()
+  {
+    std::lock_guard lock(m_mutex);
+    if (!m_fresh)
+      return nullptr;
+    std::swap(m_front, m_ready);
+    m_fresh = false;
+    return &m_slots[m_front];
+  }
+
+  // a published frame the consumer did not take yet
+  bool pending()
+  {
+    std::lock_guard lock(m_mutex);
+    return m_fresh;
+  }
+
+  u64 published() const { return m_published; }
+  u64 dropped()   const { return m_dropped; }
+
+private:
+  Frame m_slots[3];
+  usz m_back = 0, m_ready = 1, m_front = 2;
+  bool m_fresh = false;
+  u64 m_published = 0;
+  u64 m_dropped = 0;
+  std::mutex m_mutex;
+};
+
+#endif // TRIPLEBUFFER_HPP_
@@ -12,6 +12,18 @@
 #include "Time.hpp"
 #include <chrono>
 
+#if defined(__x86_64__) || defined(_M_X64)
+# define MATH_CLOCK_TSC 1
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# else
+#  include <x86intrin.h>
+#  include <cpuid.h>
+# endif
+#else
+# define MATH_CLOCK_TSC 0
+#endif
+
 namespace math
 {
 
@@ -36,6 +48,102 @@ public:
   static constexpr auto Reset = [](){ return Now(true);};
 };
 
+// Clock for hot paths: reads the invariant time stamp counter, calibrated
+// once against steady_clock on first use. Without an invariant TSC (other
+// architectures, old CPUs, some hypervisors) every call is steady_clock.
+// Ticks() is a few nanoseconds, compare ticks and convert once per report:
+//   u64 start = TscClock::Ticks();
+//   ...
+//   Time spent = TscClock::Elapsed(start);
+class TscClock
+{
+public:
+  [[nodiscard]] static u64 Ticks()
+  {
+#if MATH_CLOCK_TSC
+    if (calibration().invariant)
+      return __rdtsc();
+#endif
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // ticks to time, for differences of Ticks()
+  [[nodiscard]] static Time ToTime(u64 const ticks)
+  {
+    return nanoseconds(u64(ticks * calibration().nanoseconds_per_tick));
+  }
+
+  [[nodiscard]] static Time Elapsed(u64 const start_ticks)
+  {
+    return ToTime(Ticks() - start_ticks);
+  }
+
+  // time since the calibration, like Clock::Now()
+  [[nodiscard]] static Time Now()
+  {
+    return Elapsed(calibration().start_ticks);
+  }
+
+  [[nodiscard]] static bool Invariant() { return calibration().invariant; }
+  [[nodiscard]] static f64 TicksPerSecond() { return 1.e+9 / calibration().nanoseconds_per_tick; }
+
+private:
+  struct Calibration
+  {
+    bool invariant = false;
+    f64 nanoseconds_per_tick = 1;
+    u64 start_ticks = 0;
+  };
+
+  static Calibration const& calibration()
+  {
+    static Calibration const calibration = calibrate();
+    return calibration;
+  }
+
+  static Calibration calibrate()
+  {
+    using steady = std::chrono::steady_clock;
+    Calibration result;
+#if MATH_CLOCK_TSC
+    // CPUID 0x80000007 EDX bit 8: the TSC ticks at a constant rate in every
+    // P, C and T state, and is synchronized across cores
+    u32 regs[4] = {};
+# if defined(_MSC_VER)
+    __cpuid(reinterpret_cast<int*>(regs), 0x80000000);
+    bool const has_leaf = regs[0] >= 0x80000007;
+    if (has_leaf)
+      __cpuid(reinterpret_cast<int*>(regs), 0x80000007);
+# else
+    bool const has_leaf = __get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+# endif
+    if (has_leaf && (regs[3] & (1u << 8)))
+    {
+      // 10 ms against steady_clock puts the rate within a few ppm
+      steady::time_point const begin = steady::now();
+      u64 const begin_ticks = __rdtsc();
+      steady::time_point end;
+      do
+        end = steady::now();
+      while (end - begin < std::chrono::milliseconds(10));
+      u64 const end_ticks = __rdtsc();
+      f64 const ns = std::chrono::duration<f64, std::nano>(end - begin).count();
+      if (end_ticks > begin_ticks)
+      {
+        result.invariant = true;
+        result.nanoseconds_per_tick = ns / (end_ticks - begin_ticks);
+        result.start_ticks = end_ticks;
+        return result;
+      }
+    }
+#endif
+    result.start_ticks = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        steady::now().time_since_epoch()).count();
+    return result;
+  }
+};
+
 } // namespace math
 
 #endif // CLOCK_HPP_
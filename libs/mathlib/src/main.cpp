@@ -208,4 +208,22 @@ int main()
   math::VectorT<f32, 3> vvv(v9);
   math::VectorT<f32, 4> vvvv(v9);
   println("{}\n{}\n{}", vv, vvv, vvvv);
+
+  {
+    // the first call calibrates
+    (void)TscClock::Ticks();
+    u64 const start = Clock::Now().asNanoseconds();
+    u64 const start_ticks = TscClock::Ticks();
+    u64 previous = start_ticks;
+    while (Clock::Now().asNanoseconds() - start < 20'000'000)
+    {
+      u64 const ticks = TscClock::Ticks();
+      test(ticks >= previous);
+      previous = ticks;
+    }
+    f64 const tsc_ns = TscClock::Elapsed(start_ticks).asNanoseconds();
+    f64 const steady_ns = Clock::Now().asNanoseconds() - start;
+    test(tsc_ns > steady_ns * 0.95 && tsc_ns < steady_ns * 1.05);
+    println("TscClock: invariant {}, {:.3f} GHz", TscClock::Invariant(), TscClock::TicksPerSecond() * 1.e-9);
+  }
 }
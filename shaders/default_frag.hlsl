@@ -29,6 +29,11 @@ static const float4 palette[22] = {
   float4(1,   1,      1,     1)
 };
 
+// age shown for every level of the packed format, see palette::PackedAge
+static const int packedAge[16] = {
+  0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 18, 19, 20, 21
+};
+
 #ifdef DX12_TARGET
   ByteAddressBuffer indices : register(t0, space2);
 #else
@@ -40,15 +45,51 @@ struct Input
   float4 position  : SV_Position;
   float2 texcoord  : TEXCOORD0;
   float2 gridSize  : TEXCOORD1;
+  nointerpolation float packedCells : TEXCOORD2;
+  nointerpolation float4 uploadRect : TEXCOORD3;
+  nointerpolation float lodLevel : TEXCOORD4;
 };
 
 float4 FSmain(Input input) : SV_Target0
 {
+  if (input.lodLevel > 0.5)
+  {
+    // one u16 per 2^level x 2^level block: alive density, then the blue of
+    // the faded cells, see Pyramid.hpp. Cells are smaller than a pixel
+    // here, so the margin is blended in by its area instead of drawn.
+    int level = int(input.lodLevel);
+    int2 block = int2(floor(input.texcoord)) >> level;
+    int t = block.x + block.y * (int(input.gridSize.x) >> level);
+#ifdef DX12_TARGET
+    uint texel = (indices.Load<uint>((t / 2) * sizeof(int)) >> ((t % 2) * 16)) & 0xffff;
+#else
+    uint texel = (uint(indices[t / 2]) >> ((t % 2) * 16)) & 0xffff;
+#endif
+    float alive = (texel & 0xff) / 255.0;
+    float blue = (texel >> 8) / 255.0;
+    return lerp(float4(alive, alive + blue * 0.125, alive + blue, 1), float4(0, 0.0125, 0.1, 1), 0.36);
+  }
   float2 local = frac(input.texcoord);
   float margin = 0.1;
   if (local.x < margin || local.x > 1.0 - margin || local.y < margin || local.y > 1.0 - margin)
     return float4(0, 0.0125, 0.1, 1);
-  int i = floor(input.texcoord.x) + floor(input.texcoord.y) * input.gridSize.x;
+  // the buffer only holds the uploaded window of the grid, rows of
+  // uploadRect.z cells starting at uploadRect.xy, the rest is off screen
+  int2 cell = int2(floor(input.texcoord)) - int2(input.uploadRect.xy);
+  if (cell.x < 0 || cell.y < 0 || cell.x >= int(input.uploadRect.z) || cell.y >= int(input.uploadRect.w))
+    return palette[20];
+  int i = cell.x + cell.y * int(input.uploadRect.z);
+  if (input.packedCells > 0.5)
+  {
+    // two cells per byte, the even one in the low nibble
+    uint nibbleindex = (i % 8) * 4;
+#ifdef DX12_TARGET
+    int level = (indices.Load<int>((i / 8) * sizeof(int)) >> nibbleindex) & 0xf;
+#else
+    int level = (indices[i / 8] >> nibbleindex) & 0xf;
+#endif
+    return palette[packedAge[level]];
+  }
   uint byteindex = (i % 4) * 8;
   uint alignedoffset = (i / 4);
 #ifdef DX12_TARGET
@@ -26,21 +26,53 @@ constant float4 palette[] = {
   {1,   1,      1,     1}
 };
 
+// age shown for every level of the packed format, see palette::PackedAge
+constant int packedAge[] = {
+  0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 18, 19, 20, 21
+};
+
 struct VertexOut
 {
   float4 position [[position]];
   float2 texcoord;
   float2 gridSize;
+  float packedCells [[flat]];
+  float4 uploadRect [[flat]];
+  float lodLevel [[flat]];
 };
 
 fragment float4 FSmain(VertexOut in [[stage_in]],
                         constant int8_t* indices [[buffer(0)]])
 {
+  if (in.lodLevel > 0.5)
+  {
+    // one u16 per 2^level x 2^level block: alive density, then the blue of
+    // the faded cells, see Pyramid.hpp. Cells are smaller than a pixel
+    // here, so the margin is blended in by its area instead of drawn.
+    int level = int(in.lodLevel);
+    int2 block = int2(floor(in.texcoord)) >> level;
+    int t = block.x + block.y * (int(in.gridSize.x) >> level);
+    ushort texel = ((constant ushort*)indices)[t];
+    float alive = (texel & 0xff) / 255.0;
+    float blue = (texel >> 8) / 255.0;
+    return mix(float4(alive, alive + blue * 0.125, alive + blue, 1), float4(0, 0.0125, 0.1, 1), 0.36);
+  }
   float2 local = fract(in.texcoord);
   float margin = 0.1;
   if (local.x < margin || local.x > 1.0 - margin || local.y < margin || local.y > 1.0 - margin)
     return float4(0, 0.0125, 0.1, 1);
-  int i = floor(in.texcoord.x) + floor(in.texcoord.y) * in.gridSize.x;
+  // the buffer only holds the uploaded window of the grid, rows of
+  // uploadRect.z cells starting at uploadRect.xy, the rest is off screen
+  int2 cell = int2(floor(in.texcoord)) - int2(in.uploadRect.xy);
+  if (cell.x < 0 || cell.y < 0 || cell.x >= int(in.uploadRect.z) || cell.y >= int(in.uploadRect.w))
+    return palette[20];
+  int i = cell.x + cell.y * int(in.uploadRect.z);
+  if (in.packedCells > 0.5)
+  {
+    // two cells per byte, the even one in the low nibble
+    uint8_t packed = as_type<uint8_t>(indices[i / 2]);
+    return palette[packedAge[(i & 1) ? packed >> 4 : packed & 0xf]];
+  }
   return palette[indices[i]];
 }
 
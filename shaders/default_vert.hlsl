@@ -4,6 +4,10 @@ struct UniformBufferObject
   float2   windowSize;
   float2   gridSize;
   float    cellSide;
+  float    packedCells;
+  float2   uploadOrigin;
+  float2   uploadSize;
+  float    lodLevel;
 };
 
 cbuffer UBO : register(b0, space1)
@@ -16,6 +20,9 @@ struct Output
   float4 position  : SV_Position;
   float2 texcoord  : TEXCOORD0;
   float2 gridSize  : TEXCOORD1;
+  nointerpolation float packedCells : TEXCOORD2;
+  nointerpolation float4 uploadRect : TEXCOORD3;
+  nointerpolation float lodLevel : TEXCOORD4;
 };
 
 static const float2 VertexPositions[6] = {
@@ -33,5 +40,8 @@ Output VSmain(uint vid : SV_VertexID)
   output.position = mul(ubo.projection, float4(VertexPositions[vid] * ubo.windowSize, 0, 1));
   output.texcoord = VertexPositions[vid] * ubo.gridSize;
   output.gridSize = ubo.gridSize;
+  output.packedCells = ubo.packedCells;
+  output.uploadRect = float4(ubo.uploadOrigin, ubo.uploadSize);
+  output.lodLevel = ubo.lodLevel;
   return output;
 }
@@ -7,6 +7,10 @@ struct UniformBufferObject
   float2   windowSize;
   float2   gridSize;
   float    cellSide;
+  float    packedCells;
+  float2   uploadOrigin;
+  float2   uploadSize;
+  float    lodLevel;
 };
 
 struct VertexOut
@@ -14,6 +18,9 @@ struct VertexOut
   float4 position [[position]];
   float2 texcoord;
   float2 gridSize;
+  float packedCells [[flat]];
+  float4 uploadRect [[flat]];
+  float lodLevel [[flat]];
 };
 
 constant float2 VertexPositions[6] = {
@@ -32,6 +39,9 @@ vertex VertexOut VSmain(uint vertexID [[vertex_id]],
   out.position = ubo.projection * float4(VertexPositions[vertexID] * ubo.windowSize, 0, 1);
   out.texcoord = VertexPositions[vertexID] * ubo.gridSize;
   out.gridSize = ubo.gridSize;
+  out.packedCells = ubo.packedCells;
+  out.uploadRect = float4(ubo.uploadOrigin, ubo.uploadSize);
+  out.lodLevel = ubo.lodLevel;
   return out;
 }
 
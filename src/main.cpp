@@ -12,8 +12,33 @@
 #include <print>
 #include <cstring>
 #include <ctime>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <array>
 
 #include "Array.hpp"
+#include "Life.hpp"
+#include "FrameExporter.hpp"
+#include "Macrocell.hpp"
+#include "Checkpointer.hpp"
+#include "SharedGrid.hpp"
+#include "History.hpp"
+#include "TripleBuffer.hpp"
+#include "Pyramid.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Histogram.hpp"
+#include "Trace.hpp"
+#include "InputLog.hpp"
+#include "Stepper.hpp"
+#include "Autotune.hpp"
 
 #define RAND_CHANCE 12
 
@@ -28,6 +53,32 @@
 
 #define ARRAY_COUNT(array) (sizeof(array) / sizeof(*(array)))
 
+// dirty rows are merged until at most this many uploads are left
+#define MAX_UPLOAD_REGIONS 16
+// transfer buffers in flight, a slot is only mapped again once the GPU
+// signalled the fence of the frame that last used it
+#define TRANSFER_RING_SIZE 3
+
+// parts of a frame timed into GContext::phase_times. Step, Fade and Publish
+// run on the simulation thread, everything else on the render thread. A
+// tuned stepper runs the rule inside its bands, step includes fade then.
+enum class Phase { Input, Step, Fade, Publish, FenceMap, Memcpy, CopyPass, Acquire, Submit, Present, Frame, Count };
+constexpr char const* PhaseNames[] = {
+  "input", "step", "fade", "publish", "fence + map", "memcpy", "copy pass",
+  "swapchain", "submit", "present", "frame",
+};
+static_assert(ARRAY_COUNT(PhaseNames) == usz(Phase::Count));
+
+// keys SDL_AppIterate polls, bit k of InputLog::Frame::keys is LoggedKeys[k]
+constexpr SDL_Scancode LoggedKeys[] = {
+  SDL_SCANCODE_SPACE, SDL_SCANCODE_R, SDL_SCANCODE_E, SDL_SCANCODE_Q, SDL_SCANCODE_B,
+  SDL_SCANCODE_K, SDL_SCANCODE_J, SDL_SCANCODE_D, SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_W,
+  SDL_SCANCODE_LSHIFT, SDL_SCANCODE_RSHIFT,
+};
+
+// iterations B is held before it repeats, then it rewinds once per iteration
+constexpr u64 RewindRepeatDelay = 20;
+
 struct GContext
 {
   static const u8* VERTEX_SHADER;
@@ -54,19 +105,118 @@ struct GContext
   SDL_GPUDevice* device;
   SDL_GPUGraphicsPipeline* pipeline;
   SDL_GPUBuffer* cell_buffer;
-  SDL_GPUTransferBuffer* cell_transfer_buffer;
+  struct TransferSlot {
+    SDL_GPUTransferBuffer* buffer = nullptr;
+    SDL_GPUFence* fence = nullptr;
+  } transfer_ring[TRANSFER_RING_SIZE];
+  u32 transfer_slot = 0;
   using array_t = Array<i8, gridWidth * gridHeight>;
   array_t cells1;
   array_t cells2;
   array_t* current_cells = &cells1;
   array_t* next_cells = &cells2;
   array_t pixels;
+  // rows of pixels that changed since the last upload, everything starts dirty
+  std::vector<u8> dirty_rows = std::vector<u8>(gridHeight, 1);
+  u64 uploaded_bytes = 0;
+  // time spent before a transfer slot could be written: fence wait plus map
+  u64 uploads = 0, fence_waits = 0, map_wait_ns = 0, map_wait_max_ns = 0;
+  // --packed: the GPU reads two cells per byte from this copy of pixels.
+  // Only the frames, uploads and cell buffer are halved, pixels stays the
+  // state, so the CPU holds half a byte more per cell than without it.
+  bool packed_cells = false;
+  std::vector<u8> packed;
+  static_assert(gridWidth % 2 == 0, "packed rows must not share a byte");
+  usz render_row_bytes() const { return packed_cells ? gridWidth / 2 : gridWidth; }
+  // part of the grid held by cell_buffer, see upload_window()
+  math::iRect upload_rect;
+  static_assert(gridWidth % 8 == 0, "upload windows are aligned to 8 cells");
+  u64 generation = 0;
+  // of the last generation stepped, and births and deaths summed over the run
+  life::Counts counts;
+  // the cells were loaded, edited or rewound since counts was stepped
+  bool counts_stale = true;
+  u64 total_births = 0, total_deaths = 0;
+  // --stats: one csv line per generation
+  FILE* stats_file = nullptr;
+  // --tune: the stepper configuration measured fastest on this host, kept
+  // in tune_profile. Without one the simulation thread calls life::step.
+  std::unique_ptr<Stepper> stepper;
+  char const* tune_profile = "gol_tune.profile";
+  f64 tune_budget = 2;
+  bool tune_only = false;
+  // --record / --replay: the seed, every iteration's input and the batching
+  // of the simulation, see InputLog
+  u32 seed = 0;
+  std::unique_ptr<InputLog> input_log;
+  bool replaying() const { return input_log && input_log->replaying(); }
+  u64 iteration = 0;
+  std::array<bool, SDL_SCANCODE_COUNT> replay_keyboard{};
+  // the recorded window size, the camera of a replay follows it instead of the real window
+  InputLog::Window replay_window;
+  bool replay_finished = false;
   void swap_cells() {
     array_t* temp = current_cells;
     current_cells = next_cells;
     next_cells = temp;
+    generation++;
   }
   bool space_state[2] = {}, reset_state[2] = {}, step_state[2] = {};
+  u64 rewind_held = 0;
+  bool headless = false;
+  u64 headless_generations = 0;
+  FrameExporter::Config export_config;
+  // windowed: owned by the render thread, which exports every published frame
+  std::unique_ptr<FrameExporter> exporter;
+  char const* save_path = nullptr;
+  Checkpointer::Config checkpoint_config{.width = gridWidth, .height = gridHeight};
+  std::unique_ptr<Checkpointer> checkpointer;
+  std::unique_ptr<SharedGrid> shared_grid;
+  History::Config history_config;
+  std::unique_ptr<History> history;
+  // windowed mode steps on its own thread, see simulate(). Everything above
+  // that the step touches belongs to that thread, the render thread only
+  // posts commands and reads the published frames.
+  std::thread sim_thread;
+  std::mutex sim_mutex;
+  std::condition_variable sim_wake;
+  // input commands come from keys and clicks, commands posted with input
+  // false must never change the grid. A replayed simulation only waits for
+  // input commands.
+  struct SimCommand {
+    std::function<void(GContext&)> run;
+    bool input;
+  };
+  std::vector<SimCommand> sim_commands;
+  bool sim_running = true, sim_stop = false;
+  // how fast simulate() steps: a fixed rate, a CPU budget per displayed
+  // frame, or with neither one generation per publish as fast as possible
+  struct Schedule {
+    f64 generations_per_second = 0;
+    f64 frame_budget_ms = 0;
+  } schedule;
+  std::unique_ptr<TripleBuffer> frames;
+  // last frame taken from frames, still owned by the render thread
+  TripleBuffer::Frame* shown_frame = nullptr;
+  // averaged levels drawn instead of single cells when zoomed out, see lod_level()
+  std::unique_ptr<Pyramid> pyramid;
+  i32 lod_level = 0;
+  // --software, or no GPU device: frames are drawn by the CPU into the window surface
+  bool software = false;
+  std::unique_ptr<SoftwareRenderer> software_renderer;
+  std::vector<u8> software_pixels;
+  // --render-out: the last state drawn by the software renderer on quit
+  char const* render_out = nullptr;
+  // camera, window or anything else besides a new frame needs a redraw
+  bool redraw = true;
+  // nothing to draw and no input held: SDL only iterates after an event,
+  // the simulation thread pushes one when it publishes a frame
+  std::atomic<bool> idle = false;
+  u64 idle_iterations = 0;
+  // nanoseconds per phase, printed on quit and with H
+  Histogram phase_times[usz(Phase::Count)];
+  // builds with GOL_TRACE: the timeline is written here on quit and with T
+  char const* trace_path = "gol_trace.json";
   u64 start_time;
   u64 frame_counter = 0;
   SDL_GPUViewport viewport;
@@ -74,25 +224,77 @@ struct GContext
 
 void updateCamera(GContext& context);
 void handleResize(GContext& context);
+InputLog::Window window_state(GContext& context);
+void start_window(GContext& context);
+void apply_window(GContext& context, InputLog::Window const& window);
 void toggleFullScreen(GContext& context);
+void toggleExport(GContext& context);
+math::iRect visibleCells(GContext& context);
+math::iRect upload_window(GContext& context);
+i32 lod_level(GContext& context);
+u64 lap(GContext& context, Phase phase, u64 start);
+void print_timings(GContext& context);
+bool write_trace(GContext& context);
+bool parseArguments(GContext& context, int argc, char** argv);
+bool choose_stepper(GContext& context, bool tune);
 
 void reset_cells(GContext::array_t& cells, GContext::array_t& pixels);
+bool load_macrocell(GContext& context, char const* path);
+bool save_macrocell(GContext& context, char const* path);
+bool share_grid(GContext& context, char const* name);
+bool rewind_to(GContext& context, u64 generation);
+void begin_cells_edit(GContext& context);
+void end_cells_edit(GContext& context);
+void mark_rows_dirty(GContext& context, i32 first, i32 count);
+bool upload_dirty_rows(GContext& context, SDL_GPUCommandBuffer* command_buffer, TripleBuffer::Frame* frame);
+void next_generation(GContext& context);
+void advance(GContext& context, i32 fade_generations, u8* render = nullptr);
+void publish_frame(GContext& context, bool rendered = false);
+void simulate(GContext& context);
+void sim_post(GContext& context, std::function<void(GContext&)> command, bool input = true);
+void simulate_replay(GContext& context);
+SDL_AppResult handle_key(GContext& context, u32 key, u32 mod, bool repeat);
+bool replay_input(GContext& context, u64 iteration);
+void sim_control(GContext& context, bool running);
+void start_simulation(GContext& context);
+SoftwareRenderer::View software_view(GContext& context, i32 width);
+void present_software(GContext& context, TripleBuffer::Frame* frame);
+void set_idle(GContext& context, bool idle);
+bool write_render(GContext& context, char const* path);
 
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv)
 {
-  srand(std::time(nullptr));
+  TRACE_THREAD("main");
   static GContext context;
   *appstate = &context;
+  context.seed = u32(std::time(nullptr));
 
-  reset_cells(*context.current_cells, context.pixels);
+  if (!parseArguments(context, argc, argv))
+    return SDL_APP_FAILURE;
+  if (context.tune_only)
+    return SDL_APP_SUCCESS;
+
+  if (context.headless)
+  {
+    context.start_time = SDL_GetTicksNS();
+    return SDL_APP_CONTINUE;
+  }
 
   SDL_Init(SDL_INIT_VIDEO);
   bool const* keyboard = SDL_GetKeyboardState(nullptr);
-  context.device = SDL_CreateGPUDevice(
-      SDL_GPU_SHADERFORMAT_METALLIB
-      | SDL_GPU_SHADERFORMAT_DXIL
-      | SDL_GPU_SHADERFORMAT_SPIRV
-      , GRAPHICS_WITH_DEBUG, 0);
+  if (!context.software)
+  {
+    context.device = SDL_CreateGPUDevice(
+        SDL_GPU_SHADERFORMAT_METALLIB
+        | SDL_GPU_SHADERFORMAT_DXIL
+        | SDL_GPU_SHADERFORMAT_SPIRV
+        , GRAPHICS_WITH_DEBUG, 0);
+    if (!context.device)
+    {
+      std::println("no GPU device ({}), using the software renderer", SDL_GetError());
+      context.software = true;
+    }
+  }
   context.window = SDL_CreateWindow(
       "Game of Life Simulator",
       GContext::WindowWidth, GContext::WindowHeight,
@@ -100,6 +302,16 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv)
       // | SDL_WINDOW_FULLSCREEN
       | SDL_WINDOW_RESIZABLE
       );
+
+  if (context.software)
+  {
+    context.pixel_density = SDL_GetWindowPixelDensity(context.window);
+    context.software_renderer = std::make_unique<SoftwareRenderer>();
+    start_window(context);
+    SDL_RaiseWindow(context.window);
+    start_simulation(context);
+    return SDL_APP_CONTINUE;
+  }
   SDL_ClaimWindowForGPUDevice(context.device, context.window);
 
   context.pixel_density = SDL_GetWindowPixelDensity(context.window);
@@ -184,7 +396,7 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv)
 
   SDL_GPUBufferCreateInfo buffer_create_info{
     .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
-    .size = GContext::array_t::ByteCapacity(),
+    .size = u32(context.render_row_bytes() * GContext::gridHeight),
   };
 
   context.cell_buffer = SDL_CreateGPUBuffer(
@@ -194,17 +406,18 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv)
 
   SDL_GPUTransferBufferCreateInfo transfer_buffer_create_info{
     .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-    .size = GContext::array_t::ByteCapacity()
+    .size = u32(context.render_row_bytes() * GContext::gridHeight)
   };
 
-  context.cell_transfer_buffer = SDL_CreateGPUTransferBuffer(
-      context.device, &transfer_buffer_create_info
-      );
+  for (GContext::TransferSlot& slot : context.transfer_ring)
+    slot.buffer = SDL_CreateGPUTransferBuffer(
+        context.device, &transfer_buffer_create_info
+        );
 
-  handleResize(context);
+  start_window(context);
   SDL_SyncWindow( context.window);
   SDL_RaiseWindow(context.window);
-  context.start_time = SDL_GetTicksNS();
+  start_simulation(context);
   return SDL_APP_CONTINUE;
 }
 
@@ -216,144 +429,76 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event)
     case SDL_EVENT_QUIT:
       return SDL_APP_SUCCESS;
     case SDL_EVENT_KEY_DOWN:
-      if (event->key.key == SDLK_ESCAPE)
-        return SDL_APP_SUCCESS;
-      else if (event->key.key == SDLK_RETURN && event->key.mod & SDL_KMOD_ALT)
-        toggleFullScreen(context);
+      // a replay takes its keys from the log, escape still ends it
+      if (context.replaying())
+        return event->key.key == SDLK_ESCAPE ? SDL_APP_SUCCESS : SDL_APP_CONTINUE;
+      if (context.input_log)
+        context.input_log->logKey({context.iteration, event->key.key, event->key.mod, event->key.repeat});
+      return handle_key(context, event->key.key, event->key.mod, event->key.repeat);
+    case SDL_EVENT_WINDOW_EXPOSED:
+      context.redraw = true;
     break;
     case SDL_EVENT_WINDOW_RESIZED:
     case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+      // a replay takes its window size from the log, the real one only sets the viewport
       handleResize(context);
+      if (context.input_log && !context.replaying())
+        context.input_log->logWindow(window_state(context));
     default:
     break;
   }
   return SDL_APP_CONTINUE;
 }
 
+SDL_AppResult handle_key(GContext& context, u32 key, u32 mod, bool repeat)
+{
+  if (key == SDLK_ESCAPE)
+    return SDL_APP_SUCCESS;
+  // a replay goes fullscreen with the window record that followed
+  else if (key == SDLK_RETURN && mod & SDL_KMOD_ALT && !context.replaying())
+    toggleFullScreen(context);
+  else if (key == SDLK_P && !repeat)
+    toggleExport(context);
+  else if (key == SDLK_M && !repeat)
+    sim_post(context, [path = std::format("gol_{}.mc", context.frame_counter)](GContext& context) {
+      save_macrocell(context, path.c_str());
+    });
+  else if (key == SDLK_H && !repeat)
+    print_timings(context);
+  else if (key == SDLK_T && !repeat)
+    write_trace(context);
+  return SDL_APP_CONTINUE;
+}
+
 SDL_AppResult SDL_AppIterate(void* appstate)
 {
   GContext& context = *(GContext*)appstate;
-  auto calculateNext = [&context](const GContext::array_t::type_t* const current_cells, GContext::array_t::type_t* const next_cells) {
-    auto const gridWidth  = GContext::WindowWidth  / context.CellSide;
-    auto const gridHeight = GContext::WindowHeight / context.CellSide;
-    for (auto y = 1; y < gridHeight - 1; ++y)
-    {
-      for (auto x = 1; x < gridWidth - 1; ++x)
-      {
-        auto cellIndex = x + y * gridWidth;
-                                // east west
-        next_cells[cellIndex] = current_cells[cellIndex + 1]
-                              + current_cells[cellIndex - 1]
-                                // north and south
-                              + current_cells[cellIndex + gridWidth]
-                              + current_cells[cellIndex - gridWidth]
-                                // ne and se
-                              + current_cells[cellIndex + gridWidth + 1]
-                              + current_cells[cellIndex - gridWidth + 1]
-                                // nw and sw
-                              + current_cells[cellIndex + gridWidth - 1]
-                              + current_cells[cellIndex - gridWidth - 1];
-      }
-    }
-
-    for (auto x = 0; x < gridWidth; ++x)
-    {
-      auto nIndex = x, sIndex = x + (gridHeight - 1) * gridWidth, last_row = gridWidth * (gridHeight - 1);
-      auto x_pls_1_mod = (x + 1) % gridWidth;
-      auto x_min_1_mod = (x - 1 + gridWidth) % gridWidth;
-
-      next_cells[nIndex] = current_cells[x_pls_1_mod]
-                         + current_cells[x_min_1_mod]
-
-                         + current_cells[x + gridWidth]
-                         + current_cells[sIndex]
-
-                         + current_cells[x_pls_1_mod + gridWidth]
-                         + current_cells[x_pls_1_mod + last_row]
-
-                         + current_cells[x_min_1_mod + gridWidth]
-                         + current_cells[x_min_1_mod + last_row];
-
-      next_cells[sIndex] = current_cells[x_pls_1_mod + last_row]
-                         + current_cells[x_min_1_mod + last_row]
-
-                         + current_cells[x]
-                         + current_cells[sIndex - gridWidth]
-
-                         + current_cells[x_pls_1_mod]
-                         + current_cells[x_min_1_mod]
-
-                         + current_cells[x_pls_1_mod + gridWidth * (gridHeight - 2)]
-                         + current_cells[x_min_1_mod + gridWidth * (gridHeight - 2)];
-    }
-
-    for (auto y = 1; y < (gridHeight - 1); ++y)
-    {
-      auto eIndex = y * gridWidth, wIndex = eIndex + gridWidth - 1;
-      // north and south
-      next_cells[eIndex] = current_cells[eIndex - gridWidth]
-                         + current_cells[eIndex + gridWidth]
-      // east and west
-                         + current_cells[eIndex + 1]
-                         + current_cells[wIndex]
-      // ne and se
-                         + current_cells[eIndex - gridWidth + 1]
-                         + current_cells[eIndex + gridWidth + 1]
-      // nw and sw
-                         + current_cells[wIndex - gridWidth]
-                         + current_cells[wIndex + gridWidth];
-
-      // north and south
-      next_cells[wIndex] = current_cells[wIndex - gridWidth]
-                         + current_cells[wIndex + gridWidth]
-
-      // east and west
-                         + current_cells[eIndex]
-                         + current_cells[wIndex - 1]
-      // nw and sw
-                         + current_cells[wIndex - gridWidth - 1]
-                         + current_cells[wIndex + gridWidth - 1]
-      // ne and se
-                         + current_cells[eIndex - gridWidth]
-                         + current_cells[eIndex + gridWidth];
-    }
+  TRACE_SCOPE("iterate");
 
+  if (context.headless)
+  {
+    if (context.exporter)
+      context.exporter->submit(context.pixels.data(), GContext::gridWidth,
+                               {0, 0, GContext::gridWidth, GContext::gridHeight});
+    next_generation(context);
+    context.frame_counter++;
+    if (context.headless_generations && context.frame_counter >= context.headless_generations)
+      return SDL_APP_SUCCESS;
+    return SDL_APP_CONTINUE;
+  }
 
-    GContext::array_t::type_t* pixels = context.pixels.data();
-    for (usz i = 0; i < gridWidth * gridHeight; ++i) {
-      auto cc = current_cells[i];
-      GContext::array_t::type_t sc = next_cells[i];
-      next_cells[i] = 0;
-      GContext::array_t::type_t& result = pixels[i];
-      if (cc == 1) {
-        switch (sc) {
-        case 2:
-        case 3:
-          next_cells[i] = 1;
-          result = 21;
-          break;
-        default:
-          result = 0;
-          break;
-        }
-      } else {
-        if (sc == 3) {
-          next_cells[i] = 1;
-          result = 21;
-        } else {
-          result = std::min(20, result + 1);
-        }
-      }
-    }
-  };
-
-  static bool const* keyboard = SDL_GetKeyboardState(nullptr);
+  u64 const frame_start = SDL_GetTicksNS();
+  u64 const iteration = context.iteration++;
+  if (context.replaying() && !replay_input(context, iteration))
+    return SDL_APP_SUCCESS;
+  bool const* keyboard = context.replaying() ? context.replay_keyboard.data() : SDL_GetKeyboardState(nullptr);
   static bool updating = true;
   bool* space = context.space_state;
   space[0] = space[1];
   space[1] = keyboard[SDL_SCANCODE_SPACE];
   if (space[1] && !space[0]) {
     updating = !updating;
+    sim_control(context, updating);
   }
 
   bool* reset = context.reset_state;
@@ -361,7 +506,14 @@ SDL_AppResult SDL_AppIterate(void* appstate)
   reset[1] = keyboard[SDL_SCANCODE_R];
 
   if (reset[1] && !reset[0]) {
-    reset_cells(*context.current_cells, context.pixels);
+    sim_post(context, [](GContext& context) {
+      begin_cells_edit(context);
+      reset_cells(*context.current_cells, context.pixels);
+      end_cells_edit(context);
+      mark_rows_dirty(context, 0, GContext::gridHeight);
+      if (context.history)
+        context.history->markEdited();
+    });
   }
 
   bool* step = context.step_state;
@@ -370,12 +522,44 @@ SDL_AppResult SDL_AppIterate(void* appstate)
 
   if ((step[1] && ! step[0]) || keyboard[SDL_SCANCODE_Q]) {
     updating = false;
-    calculateNext(context.current_cells->data(), context.next_cells->data());
-    context.swap_cells();
+    sim_control(context, false);
+    sim_post(context, next_generation);
+  }
+
+  // B rewinds a generation, Shift+B a keyframe interval, held they repeat
+  if (!keyboard[SDL_SCANCODE_B])
+    context.rewind_held = 0;
+  else if (context.rewind_held++ == 0 || context.rewind_held > RewindRepeatDelay) {
+    updating = false;
+    sim_control(context, false);
+    u64 const steps = keyboard[SDL_SCANCODE_LSHIFT] || keyboard[SDL_SCANCODE_RSHIFT]
+                    ? context.history_config.keyframe_interval : 1;
+    sim_post(context, [steps](GContext& context) {
+      if (!context.history || context.history->empty())
+        return;
+      u64 const target = context.generation > steps ? context.generation - steps : 0;
+      rewind_to(context, std::max(target, context.history->oldest()));
+    });
   }
 
   math::vec3 mousepos {};
-  auto state = SDL_GetMouseState(&mousepos.x, &mousepos.y);
+  u32 state;
+  if (context.replaying())
+  {
+    InputLog::Frame const& recorded = context.input_log->frame(iteration);
+    mousepos.x = recorded.mouse_x;
+    mousepos.y = recorded.mouse_y;
+    state = recorded.buttons;
+  }
+  else
+    state = SDL_GetMouseState(&mousepos.x, &mousepos.y);
+  if (context.input_log && !context.replaying())
+  {
+    InputLog::Frame frame{.mouse_x = mousepos.x, .mouse_y = mousepos.y, .buttons = state};
+    for (usz k = 0; k < ARRAY_COUNT(LoggedKeys); ++k)
+      frame.keys |= u32(keyboard[LoggedKeys[k]]) << k;
+    context.input_log->logFrame(iteration, frame);
+  }
   static bool last_time, this_time;
   last_time = this_time;
   this_time = (state & SDL_BUTTON_LMASK) != 0;
@@ -385,10 +569,17 @@ SDL_AppResult SDL_AppIterate(void* appstate)
     u32 xx = floor(mousepos.x) / GContext::CellSide;
     u32 yy = floor(mousepos.y) / GContext::CellSide;
     u32 i = xx + yy * (GContext::WindowWidth / GContext::CellSide);
-    auto& clicked_cell = (*context.current_cells)[i];
-    auto& pixel = context.pixels[i];
-    clicked_cell = clicked_cell == 1 ? 0 : 1;
-    pixel = pixel == 21 ? 20 : 21;
+    sim_post(context, [i, yy](GContext& context) {
+      auto& clicked_cell = (*context.current_cells)[i];
+      auto& pixel = context.pixels[i];
+      begin_cells_edit(context);
+      clicked_cell = clicked_cell == 1 ? 0 : 1;
+      pixel = pixel == 21 ? 20 : 21;
+      end_cells_edit(context);
+      mark_rows_dirty(context, yy, 1);
+      if (context.history)
+        context.history->markEdited();
+    });
   }
 
   f32 zoomF = 0;
@@ -409,33 +600,46 @@ SDL_AppResult SDL_AppIterate(void* appstate)
     updateCamera(context);
   }
 
-  // first upload pass
-  void* map = SDL_MapGPUTransferBuffer(context.device, context.cell_transfer_buffer, false);
-  memcpy(map, context.pixels.data(), context.pixels.ByteCapacity());
-  SDL_UnmapGPUTransferBuffer(context.device, context.cell_transfer_buffer);
-
-  SDL_GPUCommandBuffer* command_buffer = SDL_AcquireGPUCommandBuffer(context.device);
-  SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+  u64 start = lap(context, Phase::Input, frame_start);
 
-  static SDL_GPUTransferBufferLocation location{
-    .transfer_buffer = context.cell_transfer_buffer,
-    .offset = 0
-  };
+  // the newest generation the simulation thread finished, if any
+  TripleBuffer::Frame* frame = context.frames->acquire();
+  if (frame)
+    context.sim_wake.notify_one();
+  if (!frame && !context.redraw)
+  {
+    // held keys and buttons are polled, they need iterations without events
+    bool const held = zoomF != 0 || !math::isZero(camVel) || keyboard[SDL_SCANCODE_Q] || keyboard[SDL_SCANCODE_B]
+                   || (state & SDL_BUTTON_LMASK);
+    set_idle(context, !held);
+    context.idle_iterations++;
+    return SDL_APP_CONTINUE;
+  }
+  set_idle(context, false);
+  context.redraw = false;
 
-  static SDL_GPUBufferRegion region{
-    .buffer = context.cell_buffer,
-    .offset = 0,
-    .size = GContext::array_t::ByteCapacity()
-  };
+  // exactly the generations that get shown, from the frame about to be uploaded
+  if (frame && context.exporter)
+  {
+    if (context.packed_cells)
+      context.exporter->submitPacked(frame->data.data(), GContext::gridWidth, visibleCells(context));
+    else
+      context.exporter->submit(reinterpret_cast<i8 const*>(frame->data.data()), GContext::gridWidth,
+                               visibleCells(context));
+  }
 
-  SDL_UploadToGPUBuffer(
-      copy_pass,
-      &location,
-      &region,
-      false
-      );
+  if (context.software)
+  {
+    present_software(context, frame);
+    start = lap(context, Phase::Present, start);
+    lap(context, Phase::Frame, frame_start);
+    context.frame_counter++;
+    return SDL_APP_CONTINUE;
+  }
 
-  SDL_EndGPUCopyPass(copy_pass);
+  SDL_GPUCommandBuffer* command_buffer = SDL_AcquireGPUCommandBuffer(context.device);
+  bool const uploaded = upload_dirty_rows(context, command_buffer, frame);
+  start = SDL_GetTicksNS();
 
   // then render pass
   SDL_GPUTexture* swapchain_texture;
@@ -447,6 +651,7 @@ SDL_AppResult SDL_AppIterate(void* appstate)
       &width,
       &height
       );
+  start = lap(context, Phase::Acquire, start);
 
   SDL_GPUColorTargetInfo color_target_info{
     .texture = swapchain_texture,
@@ -477,20 +682,27 @@ SDL_AppResult SDL_AppIterate(void* appstate)
     math::vec2 windowSize;
     math::vec2 gridSize;
     f32        cellSide;
-  } ubo = {context.matrices.projection * context.matrices.view, {GContext::WindowWidth, GContext::WindowHeight}, {GContext::gridWidth , GContext::gridHeight}, GContext::CellSide};
+    f32        packedCells;
+    math::vec2 uploadOrigin;
+    math::vec2 uploadSize;
+    f32        lodLevel;
+  } ubo = {context.matrices.projection * context.matrices.view, {GContext::WindowWidth, GContext::WindowHeight}, {GContext::gridWidth , GContext::gridHeight}, GContext::CellSide,
+           context.packed_cells ? 1.f : 0.f,
+           {context.upload_rect.x, context.upload_rect.y}, {context.upload_rect.w, context.upload_rect.h},
+           f32(context.lod_level)};
 
   SDL_PushGPUVertexUniformData(command_buffer, 0, &ubo, sizeof(ubo));
   SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
   SDL_EndGPURenderPass(render_pass);
-  SDL_SubmitGPUCommandBuffer(command_buffer);
-
-
-  u64 start = SDL_GetTicksNS();
-  if (updating)
+  if (uploaded)
   {
-    calculateNext(context.current_cells->data(), context.next_cells->data());
-    context.swap_cells();
+    context.transfer_ring[context.transfer_slot].fence = SDL_SubmitGPUCommandBufferAndAcquireFence(command_buffer);
+    context.transfer_slot = (context.transfer_slot + 1) % TRANSFER_RING_SIZE;
   }
+  else
+    SDL_SubmitGPUCommandBuffer(command_buffer);
+  lap(context, Phase::Submit, start);
+  lap(context, Phase::Frame, frame_start);
 
   context.frame_counter++;
   return SDL_APP_CONTINUE;
@@ -499,14 +711,93 @@ SDL_AppResult SDL_AppIterate(void* appstate)
 void SDL_AppQuit(void* appstate, SDL_AppResult result)
 {
   GContext& context = *(GContext*)appstate;
+  if (context.tune_only)
+    return;
+  if (context.sim_thread.joinable())
+  {
+    {
+      std::unique_lock lock(context.sim_mutex);
+      // the last recorded steps may still be running after the last frame
+      if (context.replaying() && context.iteration > context.input_log->frameCount())
+        context.sim_wake.wait(lock, [&] { return context.replay_finished; });
+      context.sim_stop = true;
+    }
+    context.sim_wake.notify_all();
+    context.sim_thread.join();
+  }
   u64 elapsed = SDL_GetTicksNS() - context.start_time;
   u64 ns_per_frame = elapsed / context.frame_counter;
   std::println("total elapsed   : {:7.3f} sec", elapsed * 1.e-9);
   std::println("total frames    : {:3d} frame", context.frame_counter);
   std::println("avg ms per frame: {:7.3f} ms", ns_per_frame * 1.e-6);
   std::println("fps             : {:7.3f}", context.frame_counter / (elapsed * 1.e-9));
+  if (!context.headless && !context.software)
+  {
+    std::println("avg upload      : {:7.3f} MB per frame",
+        context.frame_counter ? context.uploaded_bytes * 1.e-6 / context.frame_counter : 0.0);
+    std::println("map wait        : {:7.3f} us avg, {:7.3f} us max, {} of {} uploads waited on a fence",
+        context.uploads ? context.map_wait_ns * 1.e-3 / context.uploads : 0.0,
+        context.map_wait_max_ns * 1.e-3, context.fence_waits, context.uploads);
+  }
+  if (context.frames)
+  {
+    std::println("generations     : {}, {} never presented", context.frames->published(), context.frames->dropped());
+    std::println("idle iterations : {}", context.idle_iterations);
+  }
+  if (context.counts_stale)
+  {
+    // the simulation thread is gone, the cells can be counted here
+    u64 population = 0;
+    for (i8 cell : *context.current_cells)
+      population += cell;
+    std::println("population      : {} at generation {}, edited after it was stepped",
+        population, context.generation);
+  }
+  else
+    std::println("population      : {} at generation {}, {} births and {} deaths in it",
+        context.counts.population, context.generation, context.counts.births, context.counts.deaths);
+  if (context.generation)
+    std::println("births, deaths  : {}, {} over the run", context.total_births, context.total_deaths);
+  if (context.stats_file)
+    fclose(context.stats_file);
+  print_timings(context);
+  if (trace::Enabled)
+    write_trace(context);
+  if (context.render_out)
+    write_render(context, context.render_out);
+  if (context.exporter)
+    toggleExport(context);
+  if (context.save_path)
+    save_macrocell(context, context.save_path);
+  if (context.checkpointer)
+  {
+    Checkpointer const& checkpointer = *context.checkpointer;
+    u64 copy_ns = checkpointer.copyNanoseconds();
+    std::println("checkpoints     : {} written, {} skipped", checkpointer.written(), checkpointer.skipped());
+    std::println("checkpoint copy : {:7.3f} ms avg, {:7.3f} us per generation",
+        checkpointer.copies() ? copy_ns * 1.e-6 / checkpointer.copies() : 0.0,
+        context.generation ? copy_ns * 1.e-3 / context.generation : 0.0);
+    context.checkpointer.reset();
+  }
+  if (context.headless)
+    return;
+  if (context.software)
+  {
+    context.software_renderer.reset();
+    SDL_DestroyWindow(context.window);
+    SDL_Quit();
+    return;
+  }
   SDL_ReleaseGPUBuffer(context.device, context.cell_buffer);
-  SDL_ReleaseGPUTransferBuffer(context.device, context.cell_transfer_buffer);
+  for (GContext::TransferSlot& slot : context.transfer_ring)
+  {
+    if (slot.fence)
+    {
+      SDL_WaitForGPUFences(context.device, true, &slot.fence, 1);
+      SDL_ReleaseGPUFence(context.device, slot.fence);
+    }
+    SDL_ReleaseGPUTransferBuffer(context.device, slot.buffer);
+  }
   SDL_DestroyGPUDevice(context.device);
   SDL_DestroyWindow(context.window);
   SDL_Quit();
@@ -541,6 +832,7 @@ void updateCamera(GContext& context)
     .translate({camera.offset.x, camera.offset.y, 0})
     .scale({camera.zoom, camera.zoom, 1})
     .translate({-camera.target.x, -camera.target.y, 0});
+  context.redraw = true;
 }
 
 void reset_cells(GContext::array_t& cells, GContext::array_t& pixels) {
@@ -556,10 +848,587 @@ void reset_cells(GContext::array_t& cells, GContext::array_t& pixels) {
   }
 }
 
+bool load_macrocell(GContext& context, char const* path)
+{
+  Macrocell universe;
+  if (!universe.load(path))
+    return false;
+  GContext::array_t& cells = *context.current_cells;
+  universe.rasterize(cells.data(), GContext::gridWidth, GContext::gridHeight);
+  for (usz i = 0, count = cells.size(); i < count; ++i)
+    context.pixels[i] = cells[i] == 1 ? 21 : 20;
+  std::println("loaded {}: level {}, {} nodes", path, universe.level(), universe.nodeCount());
+  return true;
+}
+
+bool save_macrocell(GContext& context, char const* path)
+{
+  Macrocell universe = Macrocell::fromGrid(context.current_cells->data(),
+                                           GContext::gridWidth, GContext::gridHeight);
+  if (!universe.save(path))
+    return false;
+  std::println("saved {}: level {}, {} nodes", path, universe.level(), universe.nodeCount());
+  return true;
+}
+
+bool share_grid(GContext& context, char const* name)
+{
+  auto shared_grid = std::make_unique<SharedGrid>();
+  if (!shared_grid->create(name, GContext::gridWidth, GContext::gridHeight))
+    return false;
+  // from here on the simulation computes straight into the shared segment
+  context.cells1.rebind(shared_grid->cells(0));
+  context.cells2.rebind(shared_grid->cells(1));
+  context.pixels.rebind(shared_grid->ages());
+  context.shared_grid = std::move(shared_grid);
+  begin_cells_edit(context);
+  end_cells_edit(context);
+  std::println("sharing grid as {}", name);
+  return true;
+}
+
+bool rewind_to(GContext& context, u64 generation)
+{
+  if (!context.history)
+    return false;
+  begin_cells_edit(context);
+  bool restored = context.history->restore(generation, context.current_cells->data(), context.pixels.data());
+  if (restored)
+    context.generation = generation;
+  end_cells_edit(context);
+  mark_rows_dirty(context, 0, GContext::gridHeight);
+  return restored;
+}
+
+// every change of the cells, stepped or not, goes through here
+void begin_cells_edit(GContext& context)
+{
+  context.counts_stale = true;
+  if (context.shared_grid)
+    context.shared_grid->beginWrite();
+}
+
+void end_cells_edit(GContext& context)
+{
+  if (context.shared_grid)
+    context.shared_grid->endWrite(context.generation, context.current_cells == &context.cells1 ? 0 : 1);
+}
+
+void mark_rows_dirty(GContext& context, i32 first, i32 count)
+{
+  first = math::clamp(first, 0, GContext::gridHeight);
+  count = math::clamp(count, 0, GContext::gridHeight - first);
+  memset(context.dirty_rows.data() + first, 1, count);
+  // edits only touch pixels, the step kernel packs its own rows
+  if (!context.packed.empty())
+    life::packRows(context.pixels.data(), context.packed.data(), GContext::gridWidth, first, first + count);
+}
+
+void next_generation(GContext& context)
+{
+  advance(context, 1);
+}
+
+// one generation, fade_generations counts it and the unfaded ones before it.
+// render, when given, receives every row of the render format from the kernel.
+// 0 only steps the cells, for generations that are never shown: the ages
+// keep the last faded state until a later call catches up, which is also
+// what checkpoints see and rewinding restores for those generations.
+void advance(GContext& context, i32 fade_generations, u8* render)
+{
+  TRACE_SCOPE("advance");
+  begin_cells_edit(context);
+  u64 start = SDL_GetTicksNS();
+  life::Output const output{.ages = context.pixels.data(), .dirty_rows = context.dirty_rows.data(),
+                            .packed = context.packed_cells ? context.packed.data() : nullptr,
+                            .fade_generations = std::min(fade_generations, 21),
+                            .render = render, .counts = &context.counts};
+  if (context.stepper)
+  {
+    if (fade_generations)
+      context.stepper->step(context.current_cells->data(), context.next_cells->data(),
+                            GContext::gridWidth, GContext::gridHeight, output);
+    else
+      context.stepper->stepCells(context.current_cells->data(), context.next_cells->data(),
+                                 GContext::gridWidth, GContext::gridHeight, &context.counts);
+    lap(context, Phase::Step, start);
+  }
+  else
+  {
+    life::countNeighbours(context.current_cells->data(), context.next_cells->data(),
+                          GContext::gridWidth, GContext::gridHeight);
+    start = lap(context, Phase::Step, start);
+    if (fade_generations)
+      life::applyRule(context.current_cells->data(), context.next_cells->data(),
+                      GContext::gridWidth, GContext::gridHeight, output);
+    else
+      life::applyRuleCells(context.current_cells->data(), context.next_cells->data(),
+                           GContext::gridWidth, GContext::gridHeight, &context.counts);
+    lap(context, Phase::Fade, start);
+  }
+  context.swap_cells();
+  context.counts_stale = false;
+  context.total_births += context.counts.births;
+  context.total_deaths += context.counts.deaths;
+  if (context.stats_file)
+    std::println(context.stats_file, "{},{},{},{}", context.generation,
+                 context.counts.population, context.counts.births, context.counts.deaths);
+  end_cells_edit(context);
+  if (context.checkpointer)
+    context.checkpointer->onGeneration(context.generation,
+        context.current_cells->data(), context.pixels.data());
+  if (context.history)
+    context.history->record(context.generation, context.current_cells->data(), context.pixels.data(),
+                            output.fade_generations);
+}
+
+// copies what the GPU reads into the producer slot, the render thread never
+// sees pixels while they are being stepped. rendered: the step kernel
+// already wrote every row into the slot.
+void publish_frame(GContext& context, bool rendered)
+{
+  TRACE_SCOPE("publish");
+  u64 const start = SDL_GetTicksNS();
+  TripleBuffer::Frame& frame = context.frames->back();
+  u8 const* source = context.packed_cells ? context.packed.data() : (u8 const*)context.pixels.data();
+  if (!rendered)
+    memcpy(frame.data.data(), source, frame.data.size());
+  memcpy(frame.dirty_rows.data(), context.dirty_rows.data(), GContext::gridHeight);
+  memset(context.dirty_rows.data(), 0, GContext::gridHeight);
+  frame.generation = context.generation;
+  context.frames->publish();
+  lap(context, Phase::Publish, start);
+  if (context.idle.load(std::memory_order_acquire))
+  {
+    SDL_Event event{.type = SDL_EVENT_USER};
+    SDL_PushEvent(&event);
+  }
+}
+
+void set_idle(GContext& context, bool idle)
+{
+  // a replay has no events to wake it up
+  idle = idle && !context.replaying();
+  if (context.idle.load(std::memory_order_relaxed) == idle)
+    return;
+  SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, idle ? "waitevent" : "0");
+  context.idle.store(idle, std::memory_order_release);
+  // a frame published just before the flag was set pushed no event
+  if (idle && context.frames->pending())
+  {
+    SDL_Event event{.type = SDL_EVENT_USER};
+    SDL_PushEvent(&event);
+  }
+}
+
+void simulate(GContext& context)
+{
+  TRACE_THREAD("simulation");
+  using Clock = std::chrono::steady_clock;
+  GContext::Schedule const& schedule = context.schedule;
+  if (context.replaying())
+  {
+    simulate_replay(context);
+    return;
+  }
+  std::vector<GContext::SimCommand> commands;
+  // fixed rate: generations owed since rate_start, restarted after a pause
+  Clock::time_point rate_start;
+  u64 rate_done = 0;
+  bool rate_restart = true;
+  // frame budget: measured cost of an unshown and of the shown generation
+  Clock::duration step_cost{}, shown_cost{};
+  auto measure = [](Clock::duration& cost, Clock::time_point start) {
+    Clock::duration const taken = Clock::now() - start;
+    cost = cost.count() ? (cost * 3 + taken) / 4 : taken;
+  };
+  for (;;)
+  {
+    bool running;
+    // generations the schedule wants now, 0 when only commands woke us up
+    u64 due = 0;
+    {
+      std::unique_lock lock(context.sim_mutex);
+      for (;;)
+      {
+        if (context.sim_stop)
+          return;
+        running = context.sim_running;
+        if (!running)
+          rate_restart = true;
+        Clock::time_point next_due = Clock::time_point::max();
+        due = 0;
+        if (running && schedule.generations_per_second > 0)
+        {
+          Clock::time_point const now = Clock::now();
+          if (rate_restart)
+          {
+            rate_start = now;
+            rate_done = 0;
+            rate_restart = false;
+          }
+          u64 const owed = std::chrono::duration<f64>(now - rate_start).count() * schedule.generations_per_second;
+          if (owed > rate_done)
+          {
+            // falling behind drops the debt instead of spiralling
+            due = owed - rate_done;
+            rate_done = owed;
+          }
+          else
+            next_due = rate_start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<f64>((rate_done + 1) / schedule.generations_per_second));
+        }
+        else if (running && schedule.frame_budget_ms > 0)
+        {
+          // one batch per displayed frame, the renderer wakes us up
+          if (context.frames->pending())
+            next_due = Clock::now() + std::chrono::milliseconds(1);
+          else
+            due = 1;
+        }
+        else if (running)
+          due = 1;
+        if (due || !context.sim_commands.empty())
+          break;
+        if (next_due == Clock::time_point::max())
+          context.sim_wake.wait(lock);
+        else
+          context.sim_wake.wait_until(lock, next_due);
+      }
+      std::swap(commands, context.sim_commands);
+    }
+    // edits land between two generations
+    u64 input_commands = 0;
+    for (auto& command : commands)
+    {
+      command.run(context);
+      input_commands += command.input;
+    }
+    commands.clear();
+    // only the last generation of a batch is shown, so only it fades,
+    // straight into the slot that gets published next
+    u8* const render = context.frames->back().data.data();
+    i32 skipped = 0;
+    if (due && schedule.frame_budget_ms > 0)
+    {
+      auto const deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<f64, std::milli>(schedule.frame_budget_ms));
+      // a step only starts when it and the shown one still fit the budget
+      while (Clock::now() + step_cost + shown_cost <= deadline)
+      {
+        Clock::time_point const start = Clock::now();
+        advance(context, 0);
+        measure(step_cost, start);
+        skipped++;
+      }
+      Clock::time_point const start = Clock::now();
+      advance(context, skipped + 1, render);
+      measure(shown_cost, start);
+    }
+    else if (due)
+    {
+      // a rate the kernel cannot keep up with must not stall input
+      auto const deadline = Clock::now() + std::chrono::milliseconds(33);
+      for (u64 i = 1; i < due && Clock::now() < deadline; ++i)
+      {
+        advance(context, 0);
+        skipped++;
+      }
+      advance(context, skipped + 1, render);
+    }
+    if (context.input_log)
+      context.input_log->logStep({input_commands, due > 0, skipped});
+    // commands such as saving a macrocell do not change the grid
+    if (std::ranges::any_of(context.dirty_rows, [](u8 dirty) { return dirty != 0; }))
+      publish_frame(context, due > 0);
+  }
+}
+
+// simulate() with the recorded steps instead of the clock: every pass runs
+// as many input commands as it did when recording, waiting for the replayed
+// frames to post them, then steps the same batch of generations
+void simulate_replay(GContext& context)
+{
+  std::vector<GContext::SimCommand> commands;
+  InputLog::Step step;
+  while (context.input_log->nextStep(step))
+  {
+    {
+      std::unique_lock lock(context.sim_mutex);
+      std::vector<GContext::SimCommand>& queued = context.sim_commands;
+      auto enough = [&](usz& end) {
+        u64 inputs = 0;
+        for (end = 0; end < queued.size() && (inputs < step.commands || !queued[end].input); ++end)
+          inputs += queued[end].input;
+        return inputs == step.commands;
+      };
+      usz end = 0;
+      context.sim_wake.wait(lock, [&] { return context.sim_stop || enough(end); });
+      if (context.sim_stop)
+        return;
+      commands.assign(std::make_move_iterator(queued.begin()), std::make_move_iterator(queued.begin() + end));
+      queued.erase(queued.begin(), queued.begin() + end);
+    }
+    for (auto& command : commands)
+      command.run(context);
+    commands.clear();
+    if (step.stepped)
+    {
+      for (i32 i = 0; i < step.skipped; ++i)
+        advance(context, 0);
+      advance(context, step.skipped + 1, context.frames->back().data.data());
+    }
+    if (std::ranges::any_of(context.dirty_rows, [](u8 dirty) { return dirty != 0; }))
+      publish_frame(context, step.stepped);
+  }
+  std::unique_lock lock(context.sim_mutex);
+  context.replay_finished = true;
+  context.sim_wake.notify_all();
+  context.sim_wake.wait(lock, [&] { return context.sim_stop; });
+}
+
+void sim_post(GContext& context, std::function<void(GContext&)> command, bool input)
+{
+  {
+    std::lock_guard lock(context.sim_mutex);
+    context.sim_commands.push_back({std::move(command), input});
+  }
+  context.sim_wake.notify_one();
+}
+
+// the key presses and polled state of a recorded iteration, false past the end
+bool replay_input(GContext& context, u64 iteration)
+{
+  InputLog& log = *context.input_log;
+  if (iteration >= log.frameCount())
+    return false;
+  bool quit = false;
+  log.eventsBefore(iteration, [&](InputLog::Key const& key) {
+    quit |= handle_key(context, key.key, key.mod, key.repeat) == SDL_APP_SUCCESS;
+  }, [&](InputLog::Window const& window) {
+    apply_window(context, window);
+  });
+  u32 const keys = log.frame(iteration).keys;
+  for (usz k = 0; k < ARRAY_COUNT(LoggedKeys); ++k)
+    context.replay_keyboard[LoggedKeys[k]] = (keys >> k) & 1;
+  return !quit;
+}
+
+void sim_control(GContext& context, bool running)
+{
+  {
+    std::lock_guard lock(context.sim_mutex);
+    context.sim_running = running;
+  }
+  context.sim_wake.notify_one();
+}
+
+void start_simulation(GContext& context)
+{
+  context.frames = std::make_unique<TripleBuffer>(context.render_row_bytes(), GContext::gridHeight);
+  context.pyramid = std::make_unique<Pyramid>(GContext::gridWidth, GContext::gridHeight);
+  publish_frame(context);
+  context.sim_thread = std::thread(simulate, std::ref(context));
+  context.start_time = SDL_GetTicksNS();
+}
+
+// the camera as seen from `width` pixels spanning the window
+SoftwareRenderer::View software_view(GContext& context, i32 width)
+{
+  math::mat4 inverse = context.matrices.view.inverse();
+  math::vec3 first = inverse.transform(math::vec3{0.f, 0.f, 0.f});
+  math::vec3 last  = inverse.transform(math::vec3{context.current_width, context.current_height, 0.f});
+  return {first.x / GContext::CellSide, first.y / GContext::CellSide,
+          (last.x - first.x) / (GContext::CellSide * width)};
+}
+
+void present_software(GContext& context, TripleBuffer::Frame* frame)
+{
+  TRACE_SCOPE("present software");
+  if (frame)
+    context.shown_frame = frame;
+  SDL_Surface* surface = SDL_GetWindowSurface(context.window);
+  if (!surface || !context.shown_frame)
+    return;
+  context.software_pixels.resize(usz(surface->w) * surface->h * 4);
+  context.software_renderer->render(context.shown_frame->data.data(), context.packed_cells,
+                                    GContext::gridWidth, GContext::gridHeight,
+                                    software_view(context, surface->w),
+                                    context.software_pixels.data(), surface->w, surface->h);
+  // the blit converts to whatever format the window surface uses
+  SDL_Surface* source = SDL_CreateSurfaceFrom(surface->w, surface->h, SDL_PIXELFORMAT_RGBA32,
+                                              context.software_pixels.data(), surface->w * 4);
+  SDL_BlitSurface(source, nullptr, surface, nullptr);
+  SDL_DestroySurface(source);
+  SDL_UpdateWindowSurface(context.window);
+}
+
+// windowed: what the window shows, headless: the whole grid one pixel per cell
+bool write_render(GContext& context, char const* path)
+{
+  i32 width = GContext::gridWidth, height = GContext::gridHeight;
+  SoftwareRenderer::View view;
+  if (!context.headless)
+  {
+    SDL_GetWindowSizeInPixels(context.window, &width, &height);
+    view = software_view(context, width);
+  }
+  std::vector<u8> rgba(usz(width) * height * 4);
+  SoftwareRenderer renderer;
+  renderer.render((u8 const*)context.pixels.data(), false, GContext::gridWidth, GContext::gridHeight,
+                  view, rgba.data(), width, height);
+  return SoftwareRenderer::writePPM(path, rgba.data(), width, height);
+}
+
+// only rows inside the upload window are uploaded, and only its columns.
+// Moving the window re-uploads all of it from the last frame taken.
+// Zoomed out, a whole pyramid level is uploaded instead of cells.
+bool upload_dirty_rows(GContext& context, SDL_GPUCommandBuffer* command_buffer, TripleBuffer::Frame* frame)
+{
+  TRACE_SCOPE("upload");
+  if (frame)
+    context.shown_frame = frame;
+  if (!context.shown_frame)
+    return false;
+
+  i32 const level = lod_level(context);
+  bool const level_changed = level != context.lod_level;
+  context.lod_level = level;
+  math::iRect window;
+  usz GridRowBytes, RowBytes, ColumnOffset;
+  u8 const* source;
+  u8 const* dirty;
+  bool moved;
+  if (level > 0)
+  {
+    Pyramid& pyramid = *context.pyramid;
+    TRACE_SCOPE("pyramid");
+    if (frame || pyramid.stale())
+      pyramid.update(context.shown_frame->data.data(), context.packed_cells, context.shown_frame->dirty_rows.data());
+    Pyramid::Level const& lod = pyramid.level(level);
+    window = {0, 0, lod.width, lod.height};
+    GridRowBytes = RowBytes = lod.width * sizeof(u16);
+    ColumnOffset = 0;
+    source = (u8 const*)lod.texels.data();
+    dirty = lod.dirty_rows.data();
+    moved = level_changed;
+    // the cell window has to be uploaded again when zooming back in
+    context.upload_rect = {};
+  }
+  else
+  {
+    // levels are only kept up to date while one is drawn
+    context.pyramid->invalidate();
+    window = upload_window(context);
+    math::iRect const& current = context.upload_rect;
+    moved = level_changed || window.x != current.x || window.y != current.y
+         || window.w != current.w || window.h != current.h;
+    context.upload_rect = window;
+    // window rows are packed back to back in the transfer and cell buffers
+    GridRowBytes = context.render_row_bytes();
+    RowBytes = window.w * GridRowBytes / GContext::gridWidth;
+    ColumnOffset = window.x * GridRowBytes / GContext::gridWidth;
+    source = context.shown_frame->data.data();
+    dirty = context.shown_frame->dirty_rows.data();
+  }
+  if (!frame && !moved)
+    return false;
+
+  struct Range { i32 first, last; };
+  static std::vector<Range> ranges;
+  ranges.clear();
+  if (moved)
+    ranges.push_back({window.y, window.y + window.h});
+  else
+  {
+    for (i32 y = window.y; y < window.y + window.h; ++y)
+    {
+      if (!dirty[y])
+        continue;
+      if (!ranges.empty() && ranges.back().last == y)
+        ranges.back().last = y + 1;
+      else
+        ranges.push_back({y, y + 1});
+    }
+  }
+  if (ranges.empty())
+    return false;
+
+  // close the smallest gaps first, each pass doubles the gap that gets closed
+  for (i32 gap = 1; ranges.size() > MAX_UPLOAD_REGIONS; gap *= 2)
+  {
+    usz merged = 0;
+    for (usz i = 1; i < ranges.size(); ++i)
+    {
+      if (ranges[i].first - ranges[merged].last <= gap)
+        ranges[merged].last = ranges[i].last;
+      else
+        ranges[++merged] = ranges[i];
+    }
+    ranges.resize(merged + 1);
+  }
+
+  // every slot only holds the rows copied out of it in its own frame, so
+  // the slots never need to agree with each other. Mapping without cycle:
+  // the fence already guarantees the GPU is done with this slot.
+  GContext::TransferSlot& slot = context.transfer_ring[context.transfer_slot];
+  u64 wait_start = SDL_GetTicksNS();
+  if (slot.fence)
+  {
+    if (!SDL_QueryGPUFence(context.device, slot.fence))
+    {
+      context.fence_waits++;
+      SDL_WaitForGPUFences(context.device, true, &slot.fence, 1);
+    }
+    SDL_ReleaseGPUFence(context.device, slot.fence);
+    slot.fence = nullptr;
+  }
+  u8* map = (u8*)SDL_MapGPUTransferBuffer(context.device, slot.buffer, false);
+  u64 wait_ns = SDL_GetTicksNS() - wait_start;
+  u64 start = lap(context, Phase::FenceMap, wait_start);
+  context.map_wait_ns += wait_ns;
+  context.map_wait_max_ns = std::max(context.map_wait_max_ns, wait_ns);
+  context.uploads++;
+
+  // the one copy of a frame left on the CPU: the step kernel streamed the
+  // rows into the frame slot, the transfer buffers can only be mapped here.
+  // At most RowBytes * window.h per frame, the whole 3840x2160 grid is
+  // 8.3 MB of ages or 4.1 MB packed.
+  for (Range const& range : ranges)
+    for (i32 y = range.first; y < range.last; ++y)
+      memcpy(map + (y - window.y) * RowBytes,
+             source + y * GridRowBytes + ColumnOffset,
+             RowBytes);
+  SDL_UnmapGPUTransferBuffer(context.device, slot.buffer);
+  start = lap(context, Phase::Memcpy, start);
+
+  SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+  for (Range const& range : ranges)
+  {
+    u32 offset = (range.first - window.y) * RowBytes;
+    u32 size = (range.last - range.first) * RowBytes;
+    SDL_GPUTransferBufferLocation location{
+      .transfer_buffer = slot.buffer,
+      .offset = offset
+    };
+    SDL_GPUBufferRegion region{
+      .buffer = context.cell_buffer,
+      .offset = offset,
+      .size = size
+    };
+    SDL_UploadToGPUBuffer(copy_pass, &location, &region, false);
+    context.uploaded_bytes += size;
+  }
+  SDL_EndGPUCopyPass(copy_pass);
+  lap(context, Phase::CopyPass, start);
+  return true;
+}
+
 void handleResize(GContext& context)
 {
-  i32 width, height;
-  SDL_GetWindowSize(context.window, &width, &height);
+  i32 width = context.replay_window.width, height = context.replay_window.height;
+  if (!context.replaying())
+    SDL_GetWindowSize(context.window, &width, &height);
   context.matrices.projection = math::mat4::ortho(
       0, width,
       0, height,
@@ -573,6 +1442,41 @@ void handleResize(GContext& context)
   context.viewport = {0, 0, (f32)width, (f32)height};
 }
 
+InputLog::Window window_state(GContext& context)
+{
+  InputLog::Window window{.iteration = context.iteration};
+  SDL_GetWindowSize(context.window, &window.width, &window.height);
+  window.fullscreen = (SDL_GetWindowFlags(context.window) & SDL_WINDOW_FULLSCREEN) != 0;
+  return window;
+}
+
+// a recording writes the window it starts with, a replay starts from the
+// recorded one. Logs without it replay with the real window.
+void start_window(GContext& context)
+{
+  InputLog::Window window = window_state(context);
+  if (context.replaying())
+  {
+    context.input_log->startSize(window);
+    apply_window(context, window);
+    return;
+  }
+  if (context.input_log)
+    context.input_log->logSize(window);
+  handleResize(context);
+}
+
+// the real window follows as far as the window manager lets it, the camera
+// takes the recorded size either way
+void apply_window(GContext& context, InputLog::Window const& window)
+{
+  context.replay_window = window;
+  SDL_SetWindowFullscreen(context.window, window.fullscreen);
+  if (!window.fullscreen)
+    SDL_SetWindowSize(context.window, window.width, window.height);
+  handleResize(context);
+}
+
 void toggleFullScreen(GContext& context)
 {
   u32 flags = SDL_GetWindowFlags(context.window);
@@ -580,6 +1484,328 @@ void toggleFullScreen(GContext& context)
   SDL_SetWindowFullscreen(context.window, !(flags & SDL_WINDOW_FULLSCREEN));
 }
 
+void toggleExport(GContext& context)
+{
+  if (context.exporter)
+  {
+    FrameExporter& exporter = *context.exporter;
+    exporter.finish();
+    std::println("export {}: {} frames written, {} dropped",
+        exporter.prefix(), exporter.written(), exporter.dropped());
+    context.export_config.first_index = exporter.nextIndex();
+    context.exporter.reset();
+    return;
+  }
+  context.exporter = std::make_unique<FrameExporter>(context.export_config);
+  std::println("export {}: started", context.export_config.prefix);
+}
+
+math::iRect visibleCells(GContext& context)
+{
+  math::mat4 inverse = context.matrices.view.inverse();
+  math::vec3 first = inverse.transform(math::vec3{0.f, 0.f, 0.f});
+  math::vec3 last  = inverse.transform(math::vec3{context.current_width, context.current_height, 0.f});
+  i32 x0 = math::clamp<i32>(floor(first.x / GContext::CellSide), 0, GContext::gridWidth);
+  i32 y0 = math::clamp<i32>(floor(first.y / GContext::CellSide), 0, GContext::gridHeight);
+  i32 x1 = math::clamp<i32>(ceil(last.x / GContext::CellSide), 0, GContext::gridWidth);
+  i32 y1 = math::clamp<i32>(ceil(last.y / GContext::CellSide), 0, GContext::gridHeight);
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+// the visible cells plus a margin on every side, widened to multiples of
+// 8 cells so packed rows stay 4 byte aligned. The current window is kept
+// while it still covers the view and is not much larger than needed.
+math::iRect upload_window(GContext& context)
+{
+  math::iRect const visible = visibleCells(context);
+  i32 const margin_x = std::max(visible.w / 4, 64), margin_y = std::max(visible.h / 4, 64);
+  i32 const x0 = math::clamp(visible.x - margin_x, 0, GContext::gridWidth) & ~7;
+  i32 const x1 = math::min((visible.x + visible.w + margin_x + 7) & ~7, GContext::gridWidth);
+  i32 const y0 = math::clamp(visible.y - margin_y, 0, GContext::gridHeight);
+  i32 const y1 = math::clamp(visible.y + visible.h + margin_y, 0, GContext::gridHeight);
+  math::iRect const fitted{x0, y0, x1 - x0, y1 - y0};
+
+  math::iRect const& current = context.upload_rect;
+  bool const covers = visible.x >= current.x && visible.y >= current.y
+                   && visible.x + visible.w <= current.x + current.w
+                   && visible.y + visible.h <= current.y + current.h;
+  if (current.w && covers && current.w * current.h <= 4 * fitted.w * fitted.h)
+    return current;
+  return fitted;
+}
+
+// records the time since start under phase, returns now for the next lap
+u64 lap(GContext& context, Phase phase, u64 start)
+{
+  u64 now = SDL_GetTicksNS();
+  context.phase_times[usz(phase)].record(now - start);
+  return now;
+}
+
+// count and percentiles of every phase that ran at least once
+void print_timings(GContext& context)
+{
+  std::println("phase        count      p50 us      p99 us    p99.9 us      max us");
+  for (usz i = 0; i < usz(Phase::Count); ++i)
+  {
+    Histogram const& times = context.phase_times[i];
+    if (!times.count())
+      continue;
+    std::println("{:<11} {:6d} {:11.3f} {:11.3f} {:11.3f} {:11.3f}", PhaseNames[i], times.count(),
+        times.percentile(0.5) * 1.e-3, times.percentile(0.99) * 1.e-3,
+        times.percentile(0.999) * 1.e-3, times.max() * 1.e-3);
+  }
+}
+
+bool write_trace(GContext& context)
+{
+  if (!trace::Enabled)
+  {
+    std::println(stderr, "tracing needs a build with GOL_TRACE");
+    return false;
+  }
+  return trace::dump(context.trace_path);
+}
+
+// the first level that averages at least one cell per screen pixel
+i32 lod_level(GContext& context)
+{
+  math::iRect const visible = visibleCells(context);
+  f32 const cells_per_pixel = visible.w / (context.current_width * context.pixel_density);
+  i32 level = 0;
+  while (level < Pyramid::MaxLevel && cells_per_pixel >= f32(2 << level))
+    ++level;
+  return level;
+}
+
+bool parseArguments(GContext& context, int argc, char** argv)
+{
+  bool export_on_start = false;
+  char const* shm_name = nullptr;
+  char const* load_path = nullptr;
+  char const* resume_path = nullptr;
+  char const* record_path = nullptr;
+  bool tune = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string_view arg = argv[i];
+    char const* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (arg == "--headless" && value)
+    {
+      context.headless = true;
+      context.headless_generations = strtoull(value, nullptr, 10);
+      ++i;
+    }
+    else if (arg == "--load" && value)
+    {
+      load_path = value;
+      ++i;
+    }
+    else if (arg == "--save" && value)
+    {
+      context.save_path = value;
+      ++i;
+    }
+    else if (arg == "--resume" && value)
+    {
+      resume_path = value;
+      ++i;
+    }
+    else if (arg == "--record" && value)
+    {
+      record_path = value;
+      ++i;
+    }
+    else if (arg == "--replay" && value)
+    {
+      context.input_log = InputLog::replay(value);
+      if (!context.input_log)
+        return false;
+      context.seed = context.input_log->seed();
+      ++i;
+    }
+    else if (arg == "--checkpoint-every" && value)
+    {
+      context.checkpoint_config.interval = strtoull(value, nullptr, 10);
+      ++i;
+    }
+    else if (arg == "--checkpoint-keep" && value)
+    {
+      context.checkpoint_config.keep = strtoull(value, nullptr, 10);
+      ++i;
+    }
+    else if (arg == "--checkpoint-prefix" && value)
+    {
+      context.checkpoint_config.prefix = value;
+      ++i;
+    }
+    else if (arg == "--history-mb" && value)
+    {
+      context.history_config.budget_bytes = strtoull(value, nullptr, 10) << 20;
+      ++i;
+    }
+    else if (arg == "--keyframe-interval" && value)
+    {
+      context.history_config.keyframe_interval = std::max<usz>(strtoull(value, nullptr, 10), 1);
+      ++i;
+    }
+    else if (arg == "--packed")
+    {
+      context.packed_cells = true;
+    }
+    else if (arg == "--gens-per-sec" && value)
+    {
+      context.schedule.generations_per_second = strtod(value, nullptr);
+      ++i;
+    }
+    else if (arg == "--frame-budget-ms" && value)
+    {
+      context.schedule.frame_budget_ms = strtod(value, nullptr);
+      ++i;
+    }
+    else if (arg == "--software")
+    {
+      context.software = true;
+    }
+    else if (arg == "--render-out" && value)
+    {
+      context.render_out = value;
+      ++i;
+    }
+    else if (arg == "--stats" && value)
+    {
+      context.stats_file = fopen(value, "w");
+      if (!context.stats_file)
+      {
+        std::println(stderr, "could not open {}", value);
+        return false;
+      }
+      std::println(context.stats_file, "generation,population,births,deaths");
+      ++i;
+    }
+    else if (arg == "--trace" && value)
+    {
+      context.trace_path = value;
+      ++i;
+    }
+    else if (arg == "--tune")
+    {
+      tune = true;
+    }
+    else if (arg == "--tune-only")
+    {
+      tune = context.tune_only = true;
+    }
+    else if (arg == "--tune-budget" && value)
+    {
+      context.tune_budget = strtod(value, nullptr);
+      ++i;
+    }
+    else if (arg == "--tune-profile" && value)
+    {
+      context.tune_profile = value;
+      ++i;
+    }
+    else if (arg == "--shm" && value)
+    {
+      shm_name = value;
+      ++i;
+    }
+    else if (arg == "--export" && value)
+    {
+      context.export_config.prefix = value;
+      export_on_start = true;
+      ++i;
+    }
+    else if (arg == "--export-format" && value)
+    {
+      context.export_config.format = std::string_view(value) == "png"
+        ? FrameExporter::Format::PNG : FrameExporter::Format::PPM;
+      ++i;
+    }
+    else if (arg == "--export-policy" && value)
+    {
+      context.export_config.policy = std::string_view(value) == "block"
+        ? FrameExporter::Policy::Block : FrameExporter::Policy::Drop;
+      ++i;
+    }
+    else
+    {
+      std::println("usage: {} [--headless generations] [--load file.mc] [--save file.mc]"
+                   " [--resume file.ckpt] [--checkpoint-every generations] [--checkpoint-keep count]"
+                   " [--checkpoint-prefix prefix] [--shm name] [--history-mb megabytes]"
+                   " [--keyframe-interval generations] [--packed] [--software] [--render-out file.ppm]"
+                   " [--gens-per-sec rate] [--frame-budget-ms milliseconds] [--trace file.json]"
+                   " [--stats file.csv] [--tune] [--tune-only] [--tune-budget seconds]"
+                   " [--tune-profile file]"
+                   " [--record file.input] [--replay file.input]"
+                   " [--export prefix] [--export-format ppm|png] [--export-policy drop|block]", argv[0]);
+      return false;
+    }
+  }
+  // before anything else allocates or starts threads
+  if (!choose_stepper(context, tune))
+    return false;
+  if (context.tune_only)
+    return true;
+  // the seed is the only randomness, after it the grid only depends on input
+  srand(context.seed);
+  reset_cells(*context.current_cells, context.pixels);
+  if (load_path && !load_macrocell(context, load_path))
+    return false;
+  if (resume_path && !Checkpointer::restore(resume_path, GContext::gridWidth, GContext::gridHeight, context.generation,
+                                            context.current_cells->data(), context.pixels.data()))
+    return false;
+  if (record_path && !context.replaying())
+  {
+    context.input_log = InputLog::record(record_path, context.seed);
+    if (!context.input_log)
+      return false;
+  }
+  if (shm_name && !share_grid(context, shm_name))
+    return false;
+  if (context.packed_cells && !context.headless)
+  {
+    context.packed.resize(GContext::array_t::size() / 2);
+    mark_rows_dirty(context, 0, GContext::gridHeight);
+  }
+  else
+    context.packed_cells = false;
+  if (export_on_start)
+    toggleExport(context);
+  if (context.checkpoint_config.interval)
+    context.checkpointer = std::make_unique<Checkpointer>(context.checkpoint_config);
+  // only useful with the rewind key
+  if (!context.headless && context.history_config.budget_bytes)
+  {
+    context.history = std::make_unique<History>(context.history_config, GContext::array_t::size());
+    context.history->record(context.generation, context.current_cells->data(), context.pixels.data());
+  }
+  return true;
+}
+
+// --tune measures every candidate and keeps the fastest in the profile,
+// otherwise the profile line of this host and grid size is used if there is one
+bool choose_stepper(GContext& context, bool tune)
+{
+  autotune::Result result;
+  if (tune)
+  {
+    std::println("tuning the stepper for about {:.1f} s", context.tune_budget);
+    result = autotune::tune(GContext::gridWidth, GContext::gridHeight, 1. / RAND_CHANCE,
+                            context.packed_cells && !context.headless, context.tune_budget);
+    if (!autotune::save(context.tune_profile, GContext::gridWidth, GContext::gridHeight, result))
+      return false;
+  }
+  else if (!autotune::load(context.tune_profile, GContext::gridWidth, GContext::gridHeight, result))
+    return true;
+  context.stepper = std::make_unique<Stepper>(result.config);
+  std::println("stepper         : {}, {} threads, {} row bands, {:.1f} generations per second when tuned",
+               Stepper::name(result.config.kernel), result.config.threads, result.config.band_rows,
+               result.gens_per_sec);
+  return true;
+}
+
 #include "../generated/Shader.vert.hpp"
 const u8* GContext::VERTEX_SHADER = Shader_vert;
 const u64 GContext::VERTEX_SHADER_SIZE = Shader_vert_len;
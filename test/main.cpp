@@ -0,0 +1,355 @@
+//
+// main.cpp
+// GOLRenderer test
+//
+// Created by Usama Alshughry 19.10.2026.
+// Copyright © 2026 Usama Alshughry. All rights reserved.
+//
+
+#include <MyTypes.hpp>
+#include <print>
+#include <random>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <string_view>
+#include <memory>
+
+#include "Life.hpp"
+#include "Stepper.hpp"
+
+// Differential test of every stepping engine against calculateNext, the
+// lambda the first version of main.cpp stepped the grid with. The oracle is
+// kept here verbatim apart from taking the grid size as arguments, so any
+// engine that drifts from its torus wraparound shows up as a diff.
+
+// calculateNext, the reference B3/S23 step
+void reference_step(i8 const* const current_cells, i8* const next_cells, i8* const pixels,
+                    i32 const gridWidth, i32 const gridHeight)
+{
+  for (auto y = 1; y < gridHeight - 1; ++y)
+  {
+    for (auto x = 1; x < gridWidth - 1; ++x)
+    {
+      auto cellIndex = x + y * gridWidth;
+                              // east west
+      next_cells[cellIndex] = current_cells[cellIndex + 1]
+                            + current_cells[cellIndex - 1]
+                              // north and south
+                            + current_cells[cellIndex + gridWidth]
+                            + current_cells[cellIndex - gridWidth]
+                              // ne and se
+                            + current_cells[cellIndex + gridWidth + 1]
+                            + current_cells[cellIndex - gridWidth + 1]
+                              // nw and sw
+                            + current_cells[cellIndex + gridWidth - 1]
+                            + current_cells[cellIndex - gridWidth - 1];
+    }
+  }
+
+  for (auto x = 0; x < gridWidth; ++x)
+  {
+    auto nIndex = x, sIndex = x + (gridHeight - 1) * gridWidth, last_row = gridWidth * (gridHeight - 1);
+    auto x_pls_1_mod = (x + 1) % gridWidth;
+    auto x_min_1_mod = (x - 1 + gridWidth) % gridWidth;
+
+    next_cells[nIndex] = current_cells[x_pls_1_mod]
+                       + current_cells[x_min_1_mod]
+
+                       + current_cells[x + gridWidth]
+                       + current_cells[sIndex]
+
+                       + current_cells[x_pls_1_mod + gridWidth]
+                       + current_cells[x_pls_1_mod + last_row]
+
+                       + current_cells[x_min_1_mod + gridWidth]
+                       + current_cells[x_min_1_mod + last_row];
+
+    next_cells[sIndex] = current_cells[x_pls_1_mod + last_row]
+                       + current_cells[x_min_1_mod + last_row]
+
+                       + current_cells[x]
+                       + current_cells[sIndex - gridWidth]
+
+                       + current_cells[x_pls_1_mod]
+                       + current_cells[x_min_1_mod]
+
+                       + current_cells[x_pls_1_mod + gridWidth * (gridHeight - 2)]
+                       + current_cells[x_min_1_mod + gridWidth * (gridHeight - 2)];
+  }
+
+  for (auto y = 1; y < (gridHeight - 1); ++y)
+  {
+    auto eIndex = y * gridWidth, wIndex = eIndex + gridWidth - 1;
+    // north and south
+    next_cells[eIndex] = current_cells[eIndex - gridWidth]
+                       + current_cells[eIndex + gridWidth]
+    // east and west
+                       + current_cells[eIndex + 1]
+                       + current_cells[wIndex]
+    // ne and se
+                       + current_cells[eIndex - gridWidth + 1]
+                       + current_cells[eIndex + gridWidth + 1]
+    // nw and sw
+                       + current_cells[wIndex - gridWidth]
+                       + current_cells[wIndex + gridWidth];
+
+    // north and south
+    next_cells[wIndex] = current_cells[wIndex - gridWidth]
+                       + current_cells[wIndex + gridWidth]
+
+    // east and west
+                       + current_cells[eIndex]
+                       + current_cells[wIndex - 1]
+    // nw and sw
+                       + current_cells[wIndex - gridWidth - 1]
+                       + current_cells[wIndex + gridWidth - 1]
+    // ne and se
+                       + current_cells[eIndex - gridWidth]
+                       + current_cells[eIndex + gridWidth];
+  }
+
+
+  for (usz i = 0; i < usz(gridWidth) * gridHeight; ++i) {
+    auto cc = current_cells[i];
+    i8 sc = next_cells[i];
+    next_cells[i] = 0;
+    i8& result = pixels[i];
+    if (cc == 1) {
+      switch (sc) {
+      case 2:
+      case 3:
+        next_cells[i] = 1;
+        result = 21;
+        break;
+      default:
+        result = 0;
+        break;
+      }
+    } else {
+      if (sc == 3) {
+        next_cells[i] = 1;
+        result = 21;
+      } else {
+        result = std::min(20, result + 1);
+      }
+    }
+  }
+}
+
+struct State
+{
+  i32 width, height;
+  std::vector<i8> current, next, ages;
+  std::vector<u8> dirty_rows, packed, render;
+  life::Counts counts;
+
+  State(i32 width, i32 height)
+  : width{width}, height{height},
+    current(usz(width) * height), next(usz(width) * height), ages(usz(width) * height, 20),
+    dirty_rows(height), packed(usz(width) * height / 2), render(usz(width) * height)
+  {}
+};
+
+// what an engine promises to keep equal to the oracle
+enum Compared : u32 { Cells = 1, Ages = 2, Packed = 4, Render = 8 };
+
+struct Engine
+{
+  char const* name;
+  u32 compared;
+  // the packed output needs an even grid width
+  bool even_width_only;
+  // steps state by one generation, generation counts from 1
+  std::function<void(State&, u64 generation)> step;
+};
+
+// --gens-per-sec and --frame-budget-ms only fade every few generations
+constexpr u64 FadeEvery = 4;
+
+std::vector<Engine> engines()
+{
+  auto output = [](State& state) {
+    return life::Output{.ages = state.ages.data(), .dirty_rows = state.dirty_rows.data(),
+                        .counts = &state.counts};
+  };
+  // bands of 3 rows leave a partial last band on most sizes, 4 threads
+  // more than some grids have bands
+  auto stepper = [](Stepper::Kernel kernel) {
+    return std::make_shared<Stepper>(Stepper::Config{.kernel = kernel, .threads = 4, .band_rows = 3});
+  };
+  auto passes = stepper(Stepper::Kernel::Passes), fused = stepper(Stepper::Kernel::Fused);
+  return {
+    {"step", Cells | Ages, false, [=](State& state, u64) {
+      life::step(state.current.data(), state.next.data(), state.width, state.height, output(state));
+    }},
+    {"step-packed", Cells | Ages | Packed, true, [=](State& state, u64) {
+      life::Output out = output(state);
+      out.packed = state.packed.data();
+      life::step(state.current.data(), state.next.data(), state.width, state.height, out);
+    }},
+    {"step-render", Cells | Ages | Render, false, [=](State& state, u64) {
+      life::Output out = output(state);
+      out.render = state.render.data();
+      life::step(state.current.data(), state.next.data(), state.width, state.height, out);
+    }},
+    {"step-render-packed", Cells | Ages | Packed | Render, true, [=](State& state, u64) {
+      life::Output out = output(state);
+      out.packed = state.packed.data();
+      out.render = state.render.data();
+      life::step(state.current.data(), state.next.data(), state.width, state.height, out);
+    }},
+    {"step-cells", Cells, false, [](State& state, u64) {
+      life::stepCells(state.current.data(), state.next.data(), state.width, state.height, &state.counts);
+    }},
+    // ages are only equal for cells that did not blink in between, cells are always
+    {"batched-fade", Cells, false, [=](State& state, u64 generation) {
+      if (generation % FadeEvery)
+        life::stepCells(state.current.data(), state.next.data(), state.width, state.height, &state.counts);
+      else
+      {
+        life::Output out = output(state);
+        out.fade_generations = FadeEvery;
+        life::step(state.current.data(), state.next.data(), state.width, state.height, out);
+      }
+    }},
+    {"stepper-passes", Cells | Ages | Packed | Render, true, [=](State& state, u64) {
+      life::Output out = output(state);
+      out.packed = state.packed.data();
+      out.render = state.render.data();
+      passes->step(state.current.data(), state.next.data(), state.width, state.height, out);
+    }},
+    {"stepper-fused", Cells | Ages | Render, false, [=](State& state, u64) {
+      life::Output out = output(state);
+      out.render = state.render.data();
+      fused->step(state.current.data(), state.next.data(), state.width, state.height, out);
+    }},
+    {"stepper-passes-cells", Cells, false, [=](State& state, u64) {
+      passes->stepCells(state.current.data(), state.next.data(), state.width, state.height, &state.counts);
+    }},
+    {"stepper-fused-cells", Cells, false, [=](State& state, u64) {
+      fused->stepCells(state.current.data(), state.next.data(), state.width, state.height, &state.counts);
+    }},
+  };
+}
+
+// population of current, births and deaths since previous
+life::Counts reference_counts(std::vector<i8> const& previous, std::vector<i8> const& current)
+{
+  life::Counts counts;
+  for (usz i = 0; i < current.size(); ++i)
+  {
+    counts.population += current[i];
+    counts.births += current[i] && !previous[i];
+    counts.deaths += previous[i] && !current[i];
+  }
+  return counts;
+}
+
+// -1 when equal
+i64 first_difference(auto const& expected, auto const& actual)
+{
+  auto const [a, b] = std::mismatch(expected.begin(), expected.end(), actual.begin());
+  return a == expected.end() ? -1 : a - expected.begin();
+}
+
+bool report(char const* engine, char const* what, State const& state, u64 seed, u64 generation,
+            i64 index, i32 expected, i32 actual)
+{
+  // packed bytes hold two cells
+  i32 const width = std::string_view(what) == "packed" ? state.width / 2 : state.width;
+  std::println(stderr, "{}: {} differ on {}x{} seed {} at generation {}, cell ({}, {}): expected {}, got {}",
+               engine, what, state.width, state.height, seed, generation,
+               index % width, index / width, expected, actual);
+  return false;
+}
+
+bool run(Engine const& engine, i32 width, i32 height, u64 seed, u64 generations)
+{
+  std::mt19937_64 generator(seed);
+  std::bernoulli_distribution alive(std::uniform_real_distribution<f64>(0.05, 0.6)(generator));
+  State reference(width, height), state(width, height);
+  for (usz i = 0; i < reference.current.size(); ++i)
+    if (alive(generator))
+    {
+      reference.current[i] = 1;
+      reference.ages[i] = 21;
+    }
+  state.current = reference.current;
+  state.ages = reference.ages;
+  // engines only repack the rows that change, like main.cpp the copy starts complete
+  if (width % 2 == 0)
+    life::packRows(state.ages.data(), state.packed.data(), width, 0, height);
+  std::vector<u8> expected_packed(state.packed.size());
+
+  for (u64 generation = 1; generation <= generations; ++generation)
+  {
+    reference_step(reference.current.data(), reference.next.data(), reference.ages.data(), width, height);
+    std::swap(reference.current, reference.next);
+    engine.step(state, generation);
+    std::swap(state.current, state.next);
+
+    if (i64 i = first_difference(reference.current, state.current); i >= 0)
+      return report(engine.name, "cells", state, seed, generation, i, reference.current[i], state.current[i]);
+    life::Counts const expected = reference_counts(reference.next, reference.current);
+    if (expected.population != state.counts.population || expected.births != state.counts.births
+        || expected.deaths != state.counts.deaths)
+    {
+      std::println(stderr, "{}: counts differ on {}x{} seed {} at generation {}: expected {}/{}/{}, got {}/{}/{}"
+                           " (population/births/deaths)", engine.name, width, height, seed, generation,
+                   expected.population, expected.births, expected.deaths,
+                   state.counts.population, state.counts.births, state.counts.deaths);
+      return false;
+    }
+    if (engine.compared & Ages)
+      if (i64 i = first_difference(reference.ages, state.ages); i >= 0)
+        return report(engine.name, "ages", state, seed, generation, i, reference.ages[i], state.ages[i]);
+    if (engine.compared & Packed)
+    {
+      life::packRows(reference.ages.data(), expected_packed.data(), width, 0, height);
+      if (i64 i = first_difference(expected_packed, state.packed); i >= 0)
+        return report(engine.name, "packed", state, seed, generation, i, expected_packed[i], state.packed[i]);
+    }
+    if (engine.compared & Render)
+    {
+      // the render slot receives the packed copy when there is one, the ages otherwise
+      std::vector<u8> const expected = engine.compared & Packed
+                                     ? expected_packed
+                                     : std::vector<u8>(reference.ages.begin(), reference.ages.end());
+      std::vector<u8> const actual(state.render.begin(), state.render.begin() + expected.size());
+      if (i64 i = first_difference(expected, actual); i >= 0)
+        return report(engine.name, "render", state, seed, generation, i, expected[i], actual[i]);
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  struct Size { i32 width, height; };
+  // tiny and odd sizes on purpose, the wraparound loops overlap there
+  Size const sizes[] = {{2, 2}, {3, 3}, {2, 5}, {5, 2}, {4, 7}, {7, 4}, {9, 9}, {16, 16},
+                        {17, 13}, {31, 64}, {64, 31}, {130, 67}, {256, 144}};
+  u64 const seeds = 8;
+  u64 const generations = 300;
+
+  u64 runs = 0, failures = 0;
+  for (Engine const& engine : engines())
+    for (Size const size : sizes)
+    {
+      if (engine.even_width_only && size.width % 2)
+        continue;
+      for (u64 seed = 1; seed <= seeds; ++seed)
+      {
+        runs++;
+        if (!run(engine, size.width, size.height, seed, generations))
+        {
+          failures++;
+          // the first divergence is all that matters for this engine and size
+          break;
+        }
+      }
+    }
+  std::println("{} runs of {} generations, {} failed", runs, generations, failures);
+  return failures ? 1 : 0;
+}